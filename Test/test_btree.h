@@ -0,0 +1,43 @@
+//
+// Created by polarnight on 26-10-19, 下午9:40.
+//
+
+#ifndef TINYSTL_TEST_TEST_BTREE_H_
+#define TINYSTL_TEST_TEST_BTREE_H_
+
+#include <iostream>
+#include "test.h"
+#include "../btree_set.h"
+
+namespace tinystl {
+
+void btree_test() {
+  std::cout << "[============================================================"
+			   "===]\n";
+  std::cout << "[----------------- Run container test : B-tree "
+			   "--------------------]\n";
+  std::cout << "[-------------------------- API test "
+			   "---------------------------]\n";
+  int a[] = {5, 3, 1, 4, 2};
+  tinystl::btree_set<int> s1;
+  tinystl::btree_multiset<int> s2;
+  PRINT(s1);
+  FUN_AFTER(s1, s1.insert(a, a + 5));
+  FUN_AFTER(s1, s1.insert(7));
+  FUN_AFTER(s1, s1.erase(3));
+  FUN_AFTER(s1, s1.erase(s1.begin()));
+  FUN_VALUE(*s1.lower_bound(3));
+  FUN_VALUE(*s1.upper_bound(4));
+  FUN_VALUE(s1.size());
+  FUN_AFTER(s2, s2.insert(a, a + 5));
+  FUN_AFTER(s2, s2.insert(3));
+  FUN_VALUE(s2.count(3));
+  FUN_AFTER(s2, s2.erase(s2.lower_bound(2), s2.upper_bound(3)));
+  FUN_AFTER(s2, s2.clear());
+  std::cout << "[----------------------- end API test "
+			   "---------------------------]\n";
+}
+
+} // namespace tinystl
+
+#endif //TINYSTL_TEST_TEST_BTREE_H_
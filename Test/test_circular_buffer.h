@@ -0,0 +1,60 @@
+//
+// Created by polarnight on 26-10-19, 下午3:02.
+//
+
+#ifndef TINYSTL_TEST_TEST_CIRCULAR_BUFFER_H_
+#define TINYSTL_TEST_TEST_CIRCULAR_BUFFER_H_
+
+#include <iostream>
+#include "test.h"
+#include "../circular_buffer.h"
+
+namespace tinystl {
+
+void circular_buffer_test() {
+  std::cout << "[============================================================"
+			   "===]\n";
+  std::cout << "[------------- Run container test : circular_buffer "
+			   "-------------]\n";
+  std::cout << "[-------------------------- API test "
+			   "---------------------------]\n";
+  tinystl::circular_buffer<int> l1(5);
+  tinystl::circular_buffer<int> l2(3, tinystl::circular_buffer_overflow::reject);
+  tinystl::circular_buffer<int> l3 = {1, 2, 3, 4, 5};
+  tinystl::circular_buffer<int> l4(l3);
+  PRINT(l1);
+  PRINT(l2);
+  PRINT(l3);
+  PRINT(l4);
+  FUN_AFTER(l1, l1.push_back(1));
+  FUN_AFTER(l1, l1.push_back(2));
+  FUN_AFTER(l1, l1.push_front(0));
+  FUN_AFTER(l1, for (int i = 3; i < 8; ++i) l1.push_back(i));
+  FUN_AFTER(l2, for (int i = 0; i < 5; ++i) l2.push_back(i));
+  FUN_AFTER(l1, l1.pop_front());
+  FUN_AFTER(l1, l1.pop_back());
+  FUN_VALUE(*l1.begin());
+  FUN_VALUE(*(l1.end() - 1));
+  FUN_VALUE(*l1.rbegin());
+  FUN_VALUE(l1.front());
+  FUN_VALUE(l1.back());
+  FUN_VALUE(l1[1]);
+  FUN_VALUE(l1.size());
+  FUN_VALUE(l1.capacity());
+  FUN_VALUE(l1.full());
+  FUN_VALUE(l1.array_one().second);
+  FUN_VALUE(l1.array_two().second);
+  FUN_AFTER(l1, l1.linearize());
+  FUN_VALUE(l1.array_one().second);
+  FUN_VALUE(l1.array_two().second);
+  FUN_AFTER(l1, l1.swap(l3));
+  FUN_VALUE((l1 == l3));
+  FUN_AFTER(l1, l1.clear());
+  FUN_VALUE(l1.empty());
+  std::cout << "[----------------------- end API test "
+			   "---------------------------]\n";
+}
+
+} // namespace tinystl
+
+#endif //TINYSTL_TEST_TEST_CIRCULAR_BUFFER_H_
@@ -43,6 +43,28 @@ void deque_test() {
   FUN_AFTER(l1, l1.erase(l1.begin()));
   FUN_AFTER(l1, l1.erase(l1.begin(),l1.begin() + 2));
   FUN_AFTER(l1, l1.swap(l4));
+  FUN_AFTER(l1, l1.append(a, a + 5));
+  FUN_AFTER(l1, l1.append_n(3, 9));
+  // 恰好填满缓冲区（int 为 128 个元素）的 append，随后 push_back
+  tinystl::deque<int> l8;
+  FUN_AFTER(l8, l8.append_n(128, 1));
+  FUN_AFTER(l8, l8.push_back(2));
+  FUN_VALUE(l8.size());
+  FUN_VALUE(tinystl::accumulate(l8.begin(), l8.end(), 0));
+  tinystl::deque<int> l9(28, 1);
+  FUN_AFTER(l9, l9.append(l3.begin(), l3.end()));
+  FUN_AFTER(l9, l9.append_n(90, 3));
+  FUN_AFTER(l9, l9.push_back(2));
+  FUN_VALUE(l9.size());
+  FUN_VALUE(tinystl::accumulate(l9.begin(), l9.end(), 0));
+  tinystl::deque<int, Alloc, 1> l10;
+  FUN_AFTER(l10, (l10.push_front(1), l10.push_back(2), l10.push_front(3), l10.push_back(4), l10.push_back(5)));
+  FUN_AFTER(l10, l10.clear());
+  FUN_AFTER(l10, (l10.push_front(6), l10.push_front(7)));
+  FUN_VALUE(l10.size());
+  tinystl::deque<int, malloc_alloc, 4> l11(20, 4);
+  FUN_AFTER(l11, l11.insert(l11.begin(), 12, 5));
+  FUN_VALUE(l11.size());
   FUN_VALUE(*l1.begin());
   FUN_VALUE(*l1.cbegin());
   FUN_VALUE(*(--l1.end()));
@@ -57,6 +79,7 @@ void deque_test() {
   FUN_VALUE(l1.size());
   FUN_AFTER(l1, l1.resize(30, 5));
   FUN_AFTER(l1, l1.clear());
+  FUN_AFTER(l1, l1.shrink_to_fit());
   FUN_VALUE(l1.size());
   std::cout << "[----------------------- end API test "
 			   "---------------------------]\n";
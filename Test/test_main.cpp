@@ -6,6 +6,8 @@
 #include "test_list.h"
 #include "test_deque.h"
 #include "test_tree.h"
+#include "test_btree.h"
+#include "test_circular_buffer.h"
 
 int main() {
 
@@ -13,6 +15,8 @@ int main() {
   tinystl::list_test();
   tinystl::deque_test();
   tinystl::tree_test();
+  tinystl::btree_test();
+  tinystl::circular_buffer_test();
 
   return 0;
 }
\ No newline at end of file
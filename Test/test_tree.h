@@ -8,6 +8,7 @@
 #include <iostream>
 #include "test.h"
 #include "../tree.h"
+#include "../range_sum_map.h"
 #include <bits/stl_tree.h>
 
 namespace tinystl {
@@ -39,6 +40,24 @@ void tree_test() {
   FUN_VALUE(l1.max_size());
   FUN_VALUE(l1.empty());
   FUN_AFTER(l1, l1.clear());
+  FUN_AFTER(l1, l1.insert_unique(a, a + 5));
+  FUN_VALUE(l1.rb_verify());
+  FUN_AFTER(l2, l2.insert_equal(3));
+  FUN_AFTER(l1, l1.difference(l2));
+  FUN_AFTER(l1, l1.split(4, l2));
+  FUN_AFTER(l1, l1.union_unique(l2));
+  FUN_AFTER(l1, l1.append_sorted_unique(a + 3, a + 5));
+  FUN_AFTER(l2, l2.insert_unique(l1.extract(2)));
+  FUN_AFTER(l1, l1.merge_unique(l2));
+  tinystl::rb_tree<int, int, std::_Identity<int>, std::less<int>, Alloc, rb_tree_size_augment> l3;
+  FUN_AFTER(l3, l3.insert_unique(a, a + 5));
+  FUN_VALUE(*l3.select(2));
+  FUN_VALUE(l3.rank(4));
+  tinystl::range_sum_map<int, int> rs;
+  rs.add(1, 10);
+  rs.add(3, 20);
+  rs.add(5, 30);
+  FUN_VALUE((rs.sum(2, 6)));
   std::cout << "[----------------------- end API test "
 			   "---------------------------]\n";
 }
@@ -8,6 +8,7 @@
 #include <iostream>
 #include <cstring>
 #include <climits>
+#include <new> // for std::align_val_t
 
 #include "construct.h"
 
@@ -18,6 +19,9 @@
  * 未曾考虑 multi-threads 状态 */
 
 namespace tinystl {
+/* 缓存行大小，供需要对齐或填充以避免 false sharing 的结构使用 */
+constexpr size_t cache_line_size = 64;
+
 /* 使用 malloc 和 free 实现的一级分配器
  * 可由客端设置 OOM 时的 out-of-memory handler */
 class malloc_alloc {
@@ -26,6 +30,7 @@ class malloc_alloc {
  public:
   static void *allocate(size_t);
   static void deallocate(void *ptr);
+  static void deallocate(void *ptr, size_t) { deallocate(ptr); }
   static void *reallocate(void *, size_t, size_t new_sz);
   static FunPtr set_malloc_handler(FunPtr f);
 
@@ -269,6 +274,15 @@ void *default_alloc::reallocate(void *ptr, size_t old_size, size_t new_size) {
   return result;
 }
 
+/* 以缓存行对齐的方式配置空间
+ * 可作为容器的 Allocator 参数，令每个区块都从缓存行边界开始，例如 deque 的缓冲区 */
+class cache_aligned_alloc {
+ public:
+  static void *allocate(size_t n) { return ::operator new(n, std::align_val_t(cache_line_size)); }
+  static void deallocate(void *ptr) { ::operator delete(ptr, std::align_val_t(cache_line_size)); }
+  static void deallocate(void *ptr, size_t) { deallocate(ptr); }
+};
+
 #ifdef DIRECT_USE_MALLOC
 using Alloc = malloc_alloc;
 #else
@@ -299,6 +313,8 @@ class alloc {
   static void construct(T *ptr);
   static void construct(T *ptr, const T &value);
   static void construct(T *ptr, T &&value);
+  template<typename ...Args>
+  static void construct(T *ptr, Args &&...args);
 
   static void destroy(T *ptr);
   static void destroy(T *first, T *last);
@@ -348,6 +364,12 @@ void alloc<T, Alloc>::construct(T *ptr, T &&value) {
   tinystl::construct(ptr, std::move(value));
 }
 
+template<typename T, typename Alloc>
+template<typename ...Args>
+void alloc<T, Alloc>::construct(T *ptr, Args &&...args) {
+  tinystl::construct(ptr, std::forward<Args>(args)...);
+}
+
 template<typename T, typename Alloc>
 void alloc<T, Alloc>::destroy(T *ptr) {
   tinystl::destroy(ptr);
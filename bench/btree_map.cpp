@@ -0,0 +1,97 @@
+//
+// Created by polarnight on 26-10-19, 下午11:40.
+//
+
+/* btree_set/btree_map 与 rb_tree 的 set/map 的对比：随机整数的插入、查找、lower_bound 与中序遍历
+ * 编译：g++ -std=c++17 -O2 bench/btree_map.cpp -o btree_bench（可另加 -mavx2 测试节点内的 SIMD 查找）
+ * 运行：./btree_bench [元素个数，缺省 2000000] */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../set.h"
+#include "../map.h"
+#include "../btree_set.h"
+#include "../btree_map.h"
+
+namespace {
+/* 防止编译器将结果优化掉 */
+volatile long sink;
+
+class timer {
+ public:
+  timer() : start(std::chrono::steady_clock::now()) {}
+  double ms() const {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  }
+
+ private:
+  std::chrono::steady_clock::time_point start;
+};
+
+inline long key_of(int x) { return x; }
+template<typename T>
+inline long key_of(const std::pair<const int, T> &p) { return p.first; }
+
+template<typename Value>
+Value make(int k);
+template<>
+int make<int>(int k) { return k; }
+template<>
+std::pair<const int, int> make<std::pair<const int, int>>(int k) { return std::pair<const int, int>(k, k); }
+
+template<typename Container>
+void run(const char *name, const std::vector<int> &keys, const std::vector<int> &probes) {
+  using value_type = typename Container::value_type;
+  Container c;
+  timer t_insert;
+  for (int k : keys)
+	c.insert(make<value_type>(k));
+  double insert_ms = t_insert.ms();
+
+  long hits = 0;
+  timer t_find;
+  for (int k : probes)
+	hits += c.find(k) != c.end();
+  double find_ms = t_find.ms();
+
+  long sum = 0;
+  timer t_lower;
+  for (int k : probes) {
+	auto it = c.lower_bound(k);
+	if (it != c.end()) sum += key_of(*it);
+  }
+  double lower_ms = t_lower.ms();
+
+  timer t_scan;
+  for (auto it = c.begin(); it != c.end(); ++it)
+	sum += key_of(*it);
+  double scan_ms = t_scan.ms();
+  sink = hits + sum;
+
+  std::printf("%-28s insert %8.1f ms  find %8.1f ms  lower_bound %8.1f ms  scan %7.1f ms\n",
+			  name, insert_ms, find_ms, lower_ms, scan_ms);
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  long n = argc > 1 ? std::atol(argv[1]) : 2000000;
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> dist(0, 1 << 30);
+  std::vector<int> keys(n), probes(n);
+  for (int &k : keys) k = dist(gen);
+  // 一半命中、一半未命中
+  for (long i = 0; i < n; ++i)
+	probes[i] = i % 2 == 0 ? keys[gen() % n] : dist(gen);
+
+  std::printf("%ld random ints\n", n);
+  run<tinystl::set<int>>("set<int>", keys, probes);
+  run<tinystl::btree_set<int>>("btree_set<int>", keys, probes);
+  run<tinystl::btree_set<int, std::less<int>, tinystl::Alloc, 4096>>("btree_set<int, 4096 B>", keys, probes);
+  run<tinystl::map<int, int>>("map<int, int>", keys, probes);
+  run<tinystl::btree_map<int, int>>("btree_map<int, int>", keys, probes);
+  return 0;
+}
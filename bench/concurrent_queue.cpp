@@ -0,0 +1,136 @@
+//
+// Created by polarnight on 26-10-19, 下午11:50.
+//
+
+/* mpmc_queue、mpsc_queue 与加锁的 queue 的吞吐量与延迟对比
+ * 吞吐量：P 个生产者共写入 N 个元素，C 个消费者将其全部取出，报告每秒传递的元素个数；
+ * mpsc_queue 只允许一个消费者，因此只测 C = 1 的组合
+ * 延迟：两个线程以一对队列来回传递一个元素（ping-pong），报告单程的平均耗时
+ * 编译：g++ -std=c++17 -O2 -pthread bench/concurrent_queue.cpp -o cq_bench
+ * 运行：./cq_bench [元素总数，缺省 4000000] [最大线程数，缺省 hardware_concurrency] */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../concurrent_queue.h"
+#include "../queue.h"
+
+namespace {
+constexpr size_t ring_capacity = 1 << 14;
+
+/* 以一把锁保护的 queue，即无锁队列所取代的做法 */
+class locked_queue {
+ public:
+  void push(long value) {
+	std::lock_guard<std::mutex> lock(mutex);
+	queue.push(value);
+  }
+  bool try_pop(long &result) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (queue.empty())
+	  return false;
+	result = queue.pop_value();
+	return true;
+  }
+
+ private:
+  std::mutex mutex;
+  tinystl::queue<long> queue;
+};
+
+class ring_queue : public tinystl::mpmc_queue<long> {
+ public:
+  ring_queue() : tinystl::mpmc_queue<long>(ring_capacity) {}
+};
+
+using list_queue = tinystl::mpsc_queue<long>;
+
+/* 防止编译器将 pop 的结果优化掉，消费者可能有多个，因此用原子变量汇总 */
+std::atomic<long> sink(0);
+
+/* 返回每秒传递的元素个数 */
+template<typename Queue>
+double throughput(unsigned producers, unsigned consumers, long n) {
+  Queue q;
+  std::atomic<long> remaining(n);
+  std::vector<std::thread> workers;
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned p = 0; p < producers; ++p)
+	workers.push_back(std::thread([&q, p, producers, n] {
+	  for (long i = p; i < n; i += producers)
+		q.push(i);
+	}));
+  for (unsigned c = 0; c < consumers; ++c)
+	workers.push_back(std::thread([&q, &remaining] {
+	  long sum = 0;
+	  long value;
+	  while (remaining.load(std::memory_order_relaxed) > 0) {
+		if (q.try_pop(value)) {
+		  sum += value;
+		  remaining.fetch_sub(1, std::memory_order_relaxed);
+		} else {
+		  std::this_thread::yield();
+		}
+	  }
+	  sink.fetch_add(sum, std::memory_order_relaxed);
+	}));
+  for (std::thread &w : workers)
+	w.join();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return static_cast<double>(n) / seconds;
+}
+
+/* 返回单程的平均耗时（ns） */
+template<typename Queue>
+double latency(long rounds) {
+  Queue ping, pong;
+  std::thread echo([&ping, &pong, rounds] {
+	long value;
+	for (long i = 0; i < rounds; ++i) {
+	  while (!ping.try_pop(value)) std::this_thread::yield();
+	  pong.push(value);
+	}
+  });
+  long value = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < rounds; ++i) {
+	ping.push(i);
+	while (!pong.try_pop(value)) std::this_thread::yield();
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  echo.join();
+  sink.fetch_add(value, std::memory_order_relaxed);
+  return ns / (2.0 * rounds);
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  long n = argc > 1 ? std::atol(argv[1]) : 4000000;
+  unsigned max_threads = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : std::thread::hardware_concurrency();
+  if (max_threads == 0) max_threads = 1;
+
+  std::printf("throughput (Mitems/s)\n");
+  std::printf("%3s %3s %14s %14s %14s\n", "P", "C", "locked queue", "mpmc_queue", "mpsc_queue");
+  for (unsigned p = 1; p <= max_threads; p *= 2)
+	for (unsigned c = 1; c <= max_threads; c *= 2) {
+	  double locked = throughput<locked_queue>(p, c, n);
+	  double ring = throughput<ring_queue>(p, c, n);
+	  if (c == 1)
+		std::printf("%3u %3u %14.2f %14.2f %14.2f\n", p, c, locked / 1e6, ring / 1e6,
+					throughput<list_queue>(p, c, n) / 1e6);
+	  else
+		std::printf("%3u %3u %14.2f %14.2f %14s\n", p, c, locked / 1e6, ring / 1e6, "-");
+	}
+
+  long rounds = n / 40;
+  std::printf("ping-pong latency (ns, one way)\n");
+  std::printf("%14s %14s %14s\n", "locked queue", "mpmc_queue", "mpsc_queue");
+  std::printf("%14.1f %14.1f %14.1f\n", latency<locked_queue>(rounds), latency<ring_queue>(rounds),
+			  latency<list_queue>(rounds));
+  return 0;
+}
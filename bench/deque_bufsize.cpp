@@ -0,0 +1,80 @@
+//
+// Created by polarnight on 26-10-19, 下午11:10.
+//
+
+/* deque 缓冲区大小的扫描测试：对不同的 deque_buf_elems 目标字节数，分别测量 push_back 与顺序遍历的吞吐量
+ * 元素类型取 4 bytes 的 int 与 200 bytes 的 Record，后者在缺省的 512 bytes 缓冲区中每个只能放 2 个
+ * 编译：g++ -std=c++17 -O2 bench/deque_bufsize.cpp -o deque_bufsize
+ * 运行：./deque_bufsize [元素个数，缺省 4000000] */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../deque.h"
+
+namespace {
+struct Record {
+  long key;
+  char payload[192];
+};
+
+inline long key_of(int x) { return x; }
+inline long key_of(const Record &r) { return r.key; }
+inline void make(int &x, long i) { x = static_cast<int>(i); }
+inline void make(Record &r, long i) { r.key = i; }
+
+/* 防止编译器将结果优化掉 */
+volatile long sink;
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename T, typename deque_type>
+void run(const char *type_name, const char *policy, long n, int rounds) {
+  double push_best = 1e30, iter_best = 1e30;
+  for (int r = 0; r < rounds; ++r) {
+	T value;
+	auto start = std::chrono::steady_clock::now();
+	deque_type d;
+	for (long i = 0; i < n; ++i) {
+	  make(value, i);
+	  d.push_back(value);
+	}
+	double t = seconds_since(start);
+	if (t < push_best) push_best = t;
+
+	start = std::chrono::steady_clock::now();
+	long sum = 0;
+	for (typename deque_type::iterator it = d.begin(); it != d.end(); ++it)
+	  sum += key_of(*it);
+	t = seconds_since(start);
+	if (t < iter_best) iter_best = t;
+	sink = sum;
+  }
+  std::printf("%-7s %-14s %7zu elems/buf  push %8.1f Mops/s  iterate %8.1f Mops/s\n",
+			  type_name, policy, deque_type::iterator::buffer_size(),
+			  n / push_best / 1e6, n / iter_best / 1e6);
+}
+
+template<typename T>
+void sweep(const char *type_name, long n) {
+  const int rounds = 5;
+  // 缺省策略（512 bytes，不对齐）作为对照
+  run<T, tinystl::deque<T>>(type_name, "default", n, rounds);
+  run<T, tinystl::page_deque<T, 512>>(type_name, "512 B", n, rounds);
+  run<T, tinystl::page_deque<T, 1024>>(type_name, "1 KiB", n, rounds);
+  run<T, tinystl::page_deque<T, 4096>>(type_name, "4 KiB", n, rounds);
+  run<T, tinystl::page_deque<T, 16 * 1024>>(type_name, "16 KiB", n, rounds);
+  run<T, tinystl::page_deque<T, 64 * 1024>>(type_name, "64 KiB", n, rounds);
+  run<T, tinystl::page_deque<T, tinystl::deque_huge_page_buf_bytes>>(type_name, "2 MiB", n, rounds);
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  long n = argc > 1 ? std::atol(argv[1]) : 4000000;
+  sweep<int>("int", n);
+  sweep<Record>("Record", n / 8);
+  return 0;
+}
@@ -0,0 +1,75 @@
+//
+// Created by polarnight on 26-10-19, 下午11:59.
+//
+
+/* 二叉堆与 D 叉堆（D = 2, 4, 8）在 1M .. 100M 个元素上的对比
+ * make_heap：对 N 个随机键值建堆；push：逐个 push_heap 插入 N 个元素；pop：逐个 pop_heap 直至堆空
+ * 报告每个元素的平均耗时（ns）；100M 个元素时数组约 400 MB，完整运行需要数分钟
+ * 编译：g++ -std=c++17 -O2 bench/heap.cpp -o heap_bench
+ * 运行：./heap_bench [最大元素个数，缺省 100000000]，规模从 1M 起每次乘以 10 */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "../heap.h"
+
+namespace {
+/* 防止编译器将结果优化掉 */
+volatile uint32_t sink;
+
+template<typename Function>
+double time_ns(Function f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename Policy>
+void run(const char *name, const std::vector<uint32_t> &keys, std::vector<uint32_t> &heap) {
+  using iterator = std::vector<uint32_t>::iterator;
+  const size_t n = keys.size();
+  std::less<uint32_t> comp;
+
+  heap.assign(keys.begin(), keys.end());
+  double make_ns = time_ns([&] { Policy::make_heap(heap.begin(), heap.end(), comp); });
+
+  heap.clear();
+  double push_ns = time_ns([&] {
+	for (size_t i = 0; i < n; ++i) {
+	  heap.push_back(keys[i]);
+	  Policy::push_heap(heap.begin(), heap.end(), comp);
+	}
+  });
+
+  double pop_ns = time_ns([&] {
+	for (iterator last = heap.end(); last != heap.begin(); --last)
+	  Policy::pop_heap(heap.begin(), last, comp);
+  });
+  sink = heap[n / 2];
+
+  std::printf("%11zu %-14s %10.2f %10.2f %10.2f\n", n, name, make_ns / n, push_ns / n, pop_ns / n);
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t max_n = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 100000000;
+  std::mt19937 gen(42);
+  std::printf("%11s %-14s %10s %10s %10s\n", "N", "heap", "make ns/el", "push ns/el", "pop ns/el");
+  for (size_t n = 1000000; n <= max_n; n *= 10) {
+	std::vector<uint32_t> keys(n);
+	for (uint32_t &k : keys)
+	  k = static_cast<uint32_t>(gen());
+	std::vector<uint32_t> heap;
+	heap.reserve(n);
+	run<tinystl::binary_heap>("binary_heap", keys, heap);
+	run<tinystl::d_ary_heap<2>>("d_ary_heap<2>", keys, heap);
+	run<tinystl::d_ary_heap<4>>("d_ary_heap<4>", keys, heap);
+	run<tinystl::d_ary_heap<8>>("d_ary_heap<8>", keys, heap);
+  }
+  return 0;
+}
@@ -0,0 +1,92 @@
+//
+// Created by polarnight on 26-10-19, 下午11:59.
+//
+
+/* radix_priority_queue 与以 heap.h 为底层的 priority_queue 在单调时间戳上的对比
+ * 采用事件模拟中常见的 hold 模型：先放入 Q 个事件，之后每次取出时间戳最小的事件 t，再放入 t + delta（delta 随机），
+ * 因此键值单调不减，且队列长度保持为 Q。分别测试纯时间戳（uint64_t）与带负载的事件（16 bytes），报告每对 pop + push 的耗时
+ * 编译：g++ -std=c++17 -O2 bench/radix_heap.cpp -o radix_bench
+ * 运行：./radix_bench [每种规模的 hold 次数，缺省 10000000] [delta 上限，缺省 1000000] */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "../priority_queue.h"
+#include "../radix_heap.h"
+
+namespace {
+struct event {
+  uint64_t time;
+  uint64_t id;
+};
+
+struct event_later {
+  bool operator()(const event &lhs, const event &rhs) const { return lhs.time > rhs.time; }
+};
+
+struct event_time {
+  uint64_t operator()(const event &e) const { return e.time; }
+};
+
+inline uint64_t time_of(uint64_t t) { return t; }
+inline uint64_t time_of(const event &e) { return e.time; }
+inline uint64_t make_value(uint64_t t, uint64_t, uint64_t) { return t; }
+inline event make_value(uint64_t t, uint64_t id, event) { return event{t, id}; }
+
+/* 防止编译器将结果优化掉 */
+volatile uint64_t sink;
+
+/* 返回每对 pop + push 的平均耗时（ns） */
+template<typename Queue, typename Value>
+double hold(size_t queue_size, long holds, uint64_t max_delta) {
+  Queue q;
+  uint64_t seed = 88172645463325252ull;
+  auto next_delta = [&seed, max_delta] {
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+	return seed % max_delta;
+  };
+  for (size_t i = 0; i < queue_size; ++i)
+	q.push(make_value(next_delta(), i, Value()));
+
+  uint64_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < holds; ++i) {
+	uint64_t now = time_of(q.top());
+	q.pop();
+	checksum += now;
+	q.push(make_value(now + next_delta(), static_cast<uint64_t>(i), Value()));
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  sink = checksum;
+  return ns / static_cast<double>(holds);
+}
+
+template<typename Value, typename Compare, typename KeyOfValue>
+void sweep(const char *type_name, long holds, uint64_t max_delta) {
+  using binary_queue = tinystl::priority_queue<Value, tinystl::vector<Value>, Compare>;
+  using d_ary_queue = tinystl::priority_queue<Value, tinystl::vector<Value>, Compare, tinystl::d_ary_heap<4>>;
+  using radix_queue = tinystl::radix_priority_queue<Value, KeyOfValue>;
+  for (size_t q = 1024; q <= (static_cast<size_t>(1) << 20); q *= 32)
+	std::printf("%-10s %9zu %16.2f %16.2f %16.2f\n", type_name, q,
+				hold<binary_queue, Value>(q, holds, max_delta),
+				hold<d_ary_queue, Value>(q, holds, max_delta),
+				hold<radix_queue, Value>(q, holds, max_delta));
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  long holds = argc > 1 ? std::atol(argv[1]) : 10000000;
+  uint64_t max_delta = argc > 2 ? static_cast<uint64_t>(std::atoll(argv[2])) : 1000000;
+  if (max_delta == 0) max_delta = 1;
+  std::printf("%ld holds, delta in [0, %llu)\n", holds, static_cast<unsigned long long>(max_delta));
+  std::printf("%-10s %9s %16s %16s %16s\n", "value", "Q", "binary (ns/op)", "4-ary (ns/op)", "radix (ns/op)");
+  sweep<uint64_t, std::greater<uint64_t>, std::_Identity<uint64_t>>("uint64_t", holds, max_delta);
+  sweep<event, event_later, event_time>("event", holds, max_delta);
+  return 0;
+}
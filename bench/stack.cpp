@@ -0,0 +1,123 @@
+//
+// Created by polarnight on 26-10-19, 下午11:58.
+//
+
+/* vector_stack 与以 deque 为底部结构的 stack 的对比
+ * dfs：在随机图（V 个顶点，平均出度 8）上做迭代式深度优先搜索，栈中保存 (顶点, 下一条边) 的帧
+ * sawtooth：反复压入 depth 个元素再全部弹出，模拟搜索中栈的来回涨落
+ * 编译：g++ -std=c++17 -O2 bench/stack.cpp -o stack_bench
+ * 运行：./stack_bench [顶点个数，缺省 1000000] [重复次数，缺省 10] */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../stack.h"
+
+namespace {
+/* 防止编译器将结果优化掉 */
+volatile long sink;
+
+struct frame {
+  int vertex;
+  int edge; // 下一条待访问的边在邻接表中的下标
+};
+
+/* 以 CSR 形式存放的有向图 */
+struct graph {
+  std::vector<int> offset;
+  std::vector<int> target;
+};
+
+graph make_graph(int vertices, int degree) {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> dist(0, vertices - 1);
+  graph g;
+  g.offset.resize(vertices + 1);
+  g.target.resize(static_cast<size_t>(vertices) * degree);
+  for (int v = 0; v <= vertices; ++v)
+	g.offset[v] = v * degree;
+  for (int &t : g.target)
+	t = dist(gen);
+  return g;
+}
+
+template<typename Stack>
+long dfs(const graph &g, Stack &s, std::vector<char> &visited) {
+  long order = 0;
+  int vertices = static_cast<int>(g.offset.size()) - 1;
+  for (int root = 0; root < vertices; ++root) {
+	if (visited[root]) continue;
+	visited[root] = 1;
+	s.push(frame{root, g.offset[root]});
+	while (!s.empty()) {
+	  frame &f = s.top();
+	  if (f.edge == g.offset[f.vertex + 1]) {
+		order += f.vertex;
+		s.pop();
+		continue;
+	  }
+	  int next = g.target[f.edge++];
+	  if (!visited[next]) {
+		visited[next] = 1;
+		s.push(frame{next, g.offset[next]});
+	  }
+	}
+  }
+  return order;
+}
+
+template<typename Stack>
+long sawtooth(Stack &s, int depth, int rounds) {
+  long sum = 0;
+  for (int r = 0; r < rounds; ++r) {
+	for (int i = 0; i < depth; ++i)
+	  s.push(frame{i, r});
+	while (!s.empty()) {
+	  sum += s.top().vertex;
+	  s.pop();
+	}
+  }
+  return sum;
+}
+
+template<typename Function>
+double time_ms(Function f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename Stack, bool Reserve = false>
+void run(const char *name, const graph &g, int repeat) {
+  int vertices = static_cast<int>(g.offset.size()) - 1;
+  std::vector<char> visited(vertices);
+  double dfs_ms = time_ms([&] {
+	for (int r = 0; r < repeat; ++r) {
+	  Stack s;
+	  if constexpr (Reserve) s.reserve(vertices);
+	  std::fill(visited.begin(), visited.end(), 0);
+	  sink = dfs(g, s, visited);
+	}
+  });
+  double saw_ms = time_ms([&] {
+	Stack s;
+	if constexpr (Reserve) s.reserve(4096);
+	sink = sawtooth(s, 4096, repeat * 2000);
+  });
+  std::printf("%-28s dfs %9.1f ms   sawtooth %9.1f ms\n", name, dfs_ms, saw_ms);
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  int vertices = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  int repeat = argc > 2 ? std::atoi(argv[2]) : 10;
+  graph g = make_graph(vertices, 8);
+  std::printf("%d vertices, %d edges, %d repeats\n", vertices, vertices * 8, repeat);
+  run<tinystl::stack<frame>>("stack<frame> (deque)", g, repeat);
+  run<tinystl::vector_stack<frame>>("vector_stack<frame>", g, repeat);
+  run<tinystl::vector_stack<frame>, true>("vector_stack<frame> reserve", g, repeat);
+  return 0;
+}
@@ -0,0 +1,90 @@
+//
+// Created by polarnight on 26-10-19, 下午11:55.
+//
+
+/* thread_pool/task_group 的 fork-join 开销与加速比
+ * fib：递归的 fib(n)，规模小于 cutoff 时改为串行递归，cutoff 越小任务越细，越能体现调度开销
+ * reduce：对 N 个元素二分递归求和，区间小于 grain 时串行累加
+ * 对线程数 T = 1, 2, 4 .. max 分别新建 thread_pool(T)，报告耗时以及相对串行版本的加速比
+ * 编译：g++ -std=c++17 -O2 -pthread bench/thread_pool.cpp -o pool_bench
+ * 运行：./pool_bench [fib 的 n，缺省 34] [reduce 的元素个数，缺省 16777216] [最大线程数，缺省 hardware_concurrency] */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "../thread_pool.h"
+
+namespace {
+/* 防止编译器将结果优化掉 */
+volatile long sink;
+
+long fib_serial(int n) { return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2); }
+
+long fib_parallel(tinystl::thread_pool &pool, int n, int cutoff) {
+  if (n < cutoff)
+	return fib_serial(n);
+  long x;
+  tinystl::task_group group(pool);
+  group.run([&pool, &x, n, cutoff] { x = fib_parallel(pool, n - 1, cutoff); });
+  long y = fib_parallel(pool, n - 2, cutoff);
+  group.wait();
+  return x + y;
+}
+
+long reduce_serial(const long *first, const long *last) {
+  long sum = 0;
+  for (; first != last; ++first)
+	sum += *first;
+  return sum;
+}
+
+long reduce_parallel(tinystl::thread_pool &pool, const long *first, const long *last, size_t grain) {
+  if (static_cast<size_t>(last - first) <= grain)
+	return reduce_serial(first, last);
+  const long *mid = first + (last - first) / 2;
+  long left;
+  tinystl::task_group group(pool);
+  group.run([&pool, &left, first, mid, grain] { left = reduce_parallel(pool, first, mid, grain); });
+  long right = reduce_parallel(pool, mid, last, grain);
+  group.wait();
+  return left + right;
+}
+
+template<typename Function>
+double time_ms(Function f) {
+  auto start = std::chrono::steady_clock::now();
+  sink = f();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  int n = argc > 1 ? std::atoi(argv[1]) : 34;
+  size_t count = argc > 2 ? static_cast<size_t>(std::atol(argv[2])) : static_cast<size_t>(1) << 24;
+  unsigned max_threads = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : std::thread::hardware_concurrency();
+  if (max_threads == 0) max_threads = 1;
+
+  std::vector<long> data(count);
+  for (size_t i = 0; i < count; ++i)
+	data[i] = static_cast<long>(i * 2654435761u % 1000);
+  const long *first = data.data();
+  const long *last = first + count;
+
+  double fib_base = time_ms([n] { return fib_serial(n); });
+  double reduce_base = time_ms([first, last] { return reduce_serial(first, last); });
+  std::printf("serial: fib(%d) %.1f ms, reduce(%zu) %.1f ms\n", n, fib_base, count, reduce_base);
+
+  std::printf("%3s %24s %24s %24s\n", "T", "fib cutoff 20 (ms, x)", "fib cutoff 10 (ms, x)", "reduce grain 16K (ms, x)");
+  for (unsigned t = 1; t <= max_threads; t *= 2) {
+	tinystl::thread_pool pool(t);
+	double coarse = time_ms([&pool, n] { return fib_parallel(pool, n, 20); });
+	double fine = time_ms([&pool, n] { return fib_parallel(pool, n, 10); });
+	double reduce = time_ms([&pool, first, last] { return reduce_parallel(pool, first, last, 16 * 1024); });
+	std::printf("%3u %15.1f %7.2fx %15.1f %7.2fx %15.1f %7.2fx\n", t,
+				coarse, fib_base / coarse, fine, fib_base / fine, reduce, reduce_base / reduce);
+  }
+  return 0;
+}
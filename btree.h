@@ -0,0 +1,998 @@
+//
+// Created by polarnight on 26-10-19, 下午8:20.
+//
+
+#ifndef TINYSTL__BTREE_H_
+#define TINYSTL__BTREE_H_
+
+/* <btree.h> 实现了 B-tree（B+ 树），作为 btree_set/btree_multiset、btree_map/btree_multimap 的底层容器
+ * rb_tree 的每个节点只保存一个元素，另需三个指针与颜色，查找时每下降一层几乎都是一次 cache miss，3000 万个元素约 25 层。
+ * B+ 树的一个节点连续保存数十个元素，节点大小由模板参数 NodeBytes 决定（缺省 256 字节，即 4 条缓存行，
+ * 也可以设为页大小），树高约为 log_B(n)，3000 万个 int 只需 5 层左右：
+ *   叶节点（leaf）保存全部元素，并以 prev/next 串成双向链表，中序遍历即依次扫描各叶节点中连续存放的元素；
+ *   内部节点（internal）只保存分隔键值 keys 与孩子 children，children[i] 中的键值 <= keys[i] <= children[i + 1] 中的键值。
+ *   键值允许重复；分隔键值是分裂时复制而来的，对应的元素被删除后仍可保留。
+ * 插入时自顶向下预先分裂已满的节点，删除时自底向上向兄弟节点借用元素或与之合并，除根节点外每个节点至少半满。
+ *
+ * 与 rb_tree 不同，元素会在节点之间搬移，因此插入与删除使所有迭代器失效（与 vector 类似），erase 返回下一个元素的迭代器 */
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "memory.h"
+
+namespace tinystl {
+struct btree_node_base {
+  btree_node_base *parent;
+  unsigned short position; // 在父节点 children 中的下标
+  unsigned short count;    // 叶节点为元素个数，内部节点为分隔键值个数
+  bool leaf;
+};
+
+template<typename Value, size_t Slots>
+struct btree_leaf_node : public btree_node_base {
+  btree_leaf_node *prev;
+  btree_leaf_node *next;
+  alignas(Value) unsigned char storage[Slots * sizeof(Value)];
+
+  Value *slot(size_t i) { return reinterpret_cast<Value *>(storage) + i; }
+  const Value *slot(size_t i) const { return reinterpret_cast<const Value *>(storage) + i; }
+};
+
+template<typename Key, size_t Keys>
+struct btree_internal_node : public btree_node_base {
+  btree_node_base *children[Keys + 1];
+  alignas(Key) unsigned char storage[Keys * sizeof(Key)];
+
+  Key *key(size_t i) { return reinterpret_cast<Key *>(storage) + i; }
+  const Key *key(size_t i) const { return reinterpret_cast<const Key *>(storage) + i; }
+};
+
+/* 节点内查找的快速路径
+ * 键值为算术类型且以 std::less 比较时，比较没有副作用且代价极低，节点内的查找改为：
+ *   先以无分支的二分查找（比较结果经条件传送选择区间，不产生难以预测的分支）将范围缩小到 btree_search_window 个元素以内，
+ *   再统计窗口中小于（或不大于）k 的元素个数。32/64 位整数的键值连续存放时，统计以 SSE2/SSE4.2/AVX2 的
+ *   比较与 movemask 一次处理 4 到 8 个元素，其余情况逐个比较（同样无分支）。
+ * 其他键值类型或比较函数仍使用普通的二分查找 */
+constexpr size_t btree_search_window = 16;
+
+/* 统计 [keys, keys + n) 中小于 k（Less 为 true）或大于 k（Less 为 false）的元素个数 */
+template<typename Key, size_t Size = sizeof(Key), bool Integral = std::is_integral<Key>::value>
+struct btree_simd_count {
+  template<bool Less>
+  static size_t count(const Key *keys, size_t n, const Key &k) {
+	size_t c = 0;
+	for (size_t i = 0; i < n; ++i)
+	  c += Less ? keys[i] < k : k < keys[i];
+	return c;
+  }
+};
+
+#if defined(__SSE2__)
+/* 32 位整数，无符号数先与符号位异或，转为有符号比较 */
+template<typename Key>
+struct btree_simd_count<Key, 4, true> {
+  template<bool Less>
+  static size_t count(const Key *keys, size_t n, const Key &k) {
+	const int bias = std::is_signed<Key>::value ? 0 : static_cast<int>(0x80000000u);
+	const int key = static_cast<int>(k) ^ bias;
+	size_t i = 0, c = 0;
+#if defined(__AVX2__)
+	const __m256i kv8 = _mm256_set1_epi32(key);
+	const __m256i bias8 = _mm256_set1_epi32(bias);
+	for (; i + 8 <= n; i += 8) {
+	  __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i)), bias8);
+	  __m256i m = Less ? _mm256_cmpgt_epi32(kv8, v) : _mm256_cmpgt_epi32(v, kv8);
+	  c += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+	}
+#endif
+	const __m128i kv = _mm_set1_epi32(key);
+	const __m128i bias4 = _mm_set1_epi32(bias);
+	for (; i + 4 <= n; i += 4) {
+	  __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i)), bias4);
+	  __m128i m = Less ? _mm_cmpgt_epi32(kv, v) : _mm_cmpgt_epi32(v, kv);
+	  c += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(m)));
+	}
+	for (; i < n; ++i)
+	  c += Less ? keys[i] < k : k < keys[i];
+	return c;
+  }
+};
+#endif
+
+#if defined(__SSE4_2__) || defined(__AVX2__)
+/* 64 位整数，有符号的 64 位比较需要 SSE4.2 */
+template<typename Key>
+struct btree_simd_count<Key, 8, true> {
+  template<bool Less>
+  static size_t count(const Key *keys, size_t n, const Key &k) {
+	const long long bias = std::is_signed<Key>::value ? 0 : static_cast<long long>(0x8000000000000000ull);
+	const long long key = static_cast<long long>(k) ^ bias;
+	size_t i = 0, c = 0;
+#if defined(__AVX2__)
+	const __m256i kv4 = _mm256_set1_epi64x(key);
+	const __m256i bias4 = _mm256_set1_epi64x(bias);
+	for (; i + 4 <= n; i += 4) {
+	  __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i)), bias4);
+	  __m256i m = Less ? _mm256_cmpgt_epi64(kv4, v) : _mm256_cmpgt_epi64(v, kv4);
+	  c += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(m)));
+	}
+#endif
+	const __m128i kv = _mm_set1_epi64x(key);
+	const __m128i bias2 = _mm_set1_epi64x(bias);
+	for (; i + 2 <= n; i += 2) {
+	  __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i)), bias2);
+	  __m128i m = Less ? _mm_cmpgt_epi64(kv, v) : _mm_cmpgt_epi64(v, kv);
+	  c += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(m)));
+	}
+	for (; i < n; ++i)
+	  c += Less ? keys[i] < k : k < keys[i];
+	return c;
+  }
+};
+#endif
+
+/* 无分支的二分查找，将 lower_bound（Upper 为 false）或 upper_bound（Upper 为 true）的结果
+ * 限定在 [base, base + len] 内，直到 len 不超过 btree_search_window */
+template<bool Upper, typename Key, typename GetKey>
+inline size_t btree_narrow(size_t &len, const Key &k, GetKey get) {
+  size_t base = 0;
+  while (len > btree_search_window) {
+	size_t half = len / 2;
+	bool right = Upper ? !(k < get(base + half)) : get(base + half) < k;
+	base = right ? base + half : base;
+	len -= half;
+  }
+  return base;
+}
+
+/* 键值连续存放：返回 [keys, keys + n) 中第一个不小于（Upper 为 false）或大于（Upper 为 true）k 的下标 */
+template<bool Upper, typename Key>
+inline size_t btree_fast_search(const Key *keys, size_t n, const Key &k) {
+  size_t len = n;
+  size_t base = btree_narrow<Upper>(len, k, [keys](size_t i) -> const Key & { return keys[i]; });
+  return base + (Upper ? len - btree_simd_count<Key>::template count<false>(keys + base, len, k)
+					   : btree_simd_count<Key>::template count<true>(keys + base, len, k));
+}
+
+/* 键值不连续存放（如 map 的叶节点），get(i) 返回第 i 个键值 */
+template<bool Upper, typename Key, typename GetKey>
+inline size_t btree_fast_search(size_t n, const Key &k, GetKey get) {
+  size_t len = n;
+  size_t base = btree_narrow<Upper>(len, k, get);
+  size_t c = 0;
+  for (size_t i = base; i < base + len; ++i)
+	c += Upper ? !(k < get(i)) : get(i) < k;
+  return base + c;
+}
+
+/* 迭代器为（叶节点, 下标），end() 为最右叶节点的尾后位置 */
+template<typename Value, typename Ref, typename Ptr, typename Leaf>
+struct btree_iterator {
+  using iterator_category = bidirectional_iterator_tag;
+  using value_type = Value;
+  using difference_type = ptrdiff_t;
+  using reference = Ref;
+  using pointer = Ptr;
+  using iterator = btree_iterator<Value, Value &, Value *, Leaf>;
+  using const_iterator = btree_iterator<Value, const Value &, const Value *, Leaf>;
+  using self = btree_iterator<Value, Ref, Ptr, Leaf>;
+
+  Leaf *node;
+  size_t position;
+
+  btree_iterator() : node(nullptr), position(0) {}
+  btree_iterator(Leaf *x, size_t pos) : node(x), position(pos) {}
+  btree_iterator(const iterator &rhs) : node(rhs.node), position(rhs.position) {}
+  btree_iterator(const const_iterator &rhs) : node(rhs.node), position(rhs.position) {}
+
+  reference operator*() const { return *node->slot(position); }
+  pointer operator->() const { return &(operator*()); }
+
+  self &operator++() {
+	if (++position == node->count && node->next != nullptr) {
+	  node = node->next;
+	  position = 0;
+	}
+	return *this;
+  }
+  self operator++(int) {
+	self tmp = *this;
+	++*this;
+	return tmp;
+  }
+  self &operator--() {
+	if (position == 0) {
+	  node = node->prev;
+	  position = node->count;
+	}
+	--position;
+	return *this;
+  }
+  self operator--(int) {
+	self tmp = *this;
+	--*this;
+	return tmp;
+  }
+
+  bool operator==(const self &rhs) const { return node == rhs.node && position == rhs.position; }
+  bool operator!=(const self &rhs) const { return !(*this == rhs); }
+};
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare = std::less<Key>,
+		 typename Allocator = Alloc, size_t NodeBytes = 256>
+class btree {
+ public:
+  using key_type = Key;
+  using value_type = Value;
+  using pointer = value_type *;
+  using const_pointer = const value_type *;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+
+ protected:
+  using base_ptr = btree_node_base *;
+
+  /* 按 NodeBytes 计算每个节点的容量，至少保证分裂与合并能够进行 */
+  static constexpr size_type leaf_header = sizeof(btree_node_base) + 2 * sizeof(void *);
+  static constexpr size_type internal_header = sizeof(btree_node_base) + sizeof(void *);
+  static constexpr size_type leaf_fit = NodeBytes > leaf_header ? (NodeBytes - leaf_header) / sizeof(Value) : 0;
+  static constexpr size_type internal_fit =
+	  NodeBytes > internal_header ? (NodeBytes - internal_header) / (sizeof(Key) + sizeof(void *)) : 0;
+
+ public:
+  static constexpr size_type leaf_slots = leaf_fit < 4 ? 4 : leaf_fit;
+  static constexpr size_type internal_keys = internal_fit < 3 ? 3 : internal_fit;
+
+ protected:
+  static constexpr size_type leaf_min = leaf_slots / 2;
+  static constexpr size_type internal_min = internal_keys / 2;
+  static_assert(leaf_slots <= 0xffff && internal_keys <= 0xffff, "btree node is too large");
+
+  using leaf_node = btree_leaf_node<Value, leaf_slots>;
+  using internal_node = btree_internal_node<Key, internal_keys>;
+  using leaf_allocator = alloc<leaf_node, Allocator>;
+  using internal_allocator = alloc<internal_node, Allocator>;
+
+ public:
+  using iterator = btree_iterator<value_type, reference, pointer, leaf_node>;
+  using const_iterator = btree_iterator<value_type, const_reference, const_pointer, leaf_node>;
+  using reverse_iterator = tinystl::reverse_iterator<iterator>;
+  using const_reverse_iterator = tinystl::reverse_iterator<const_iterator>;
+
+ private:
+  base_ptr root;
+  leaf_node *leftmost;
+  leaf_node *rightmost;
+  size_type node_count;
+  Compare key_compare;
+
+  static leaf_node *as_leaf(base_ptr x) { return static_cast<leaf_node *>(x); }
+  static internal_node *as_internal(base_ptr x) { return static_cast<internal_node *>(x); }
+  static const Key &key(const leaf_node *x, size_type i) { return KeyOfValue()(*x->slot(i)); }
+  static bool is_full(base_ptr x) { return x->count == (x->leaf ? leaf_slots : internal_keys); }
+
+  leaf_node *create_leaf() {
+	leaf_node *x = leaf_allocator::allocate();
+	x->parent = nullptr;
+	x->position = 0;
+	x->count = 0;
+	x->leaf = true;
+	x->prev = nullptr;
+	x->next = nullptr;
+	return x;
+  }
+  internal_node *create_internal() {
+	internal_node *x = internal_allocator::allocate();
+	x->parent = nullptr;
+	x->position = 0;
+	x->count = 0;
+	x->leaf = false;
+	return x;
+  }
+  void destroy_node(base_ptr x);
+
+  /* 节点内的查找，返回第一个不小于（lower）或大于（upper）k 的下标
+   * fast_search 为 true 时使用 btree_fast_search，叶节点中的元素即键值时（set）按连续存放的键值查找 */
+  using fast_search = std::integral_constant<bool, std::is_arithmetic<Key>::value &&
+	  std::is_same<Compare, std::less<Key>>::value>;
+  using contiguous_leaf_keys = std::integral_constant<bool, std::is_same<Value, Key>::value &&
+	  std::is_same<KeyOfValue, std::_Identity<Value>>::value>;
+
+  template<bool Upper, typename GetKey>
+  size_type binary_search(size_type n, const Key &k, GetKey get) const {
+	size_type lo = 0, hi = n;
+	while (lo < hi) {
+	  size_type mid = (lo + hi) / 2;
+	  if (Upper ? !key_compare(k, get(mid)) : key_compare(get(mid), k)) lo = mid + 1;
+	  else hi = mid;
+	}
+	return lo;
+  }
+  template<bool Upper>
+  size_type internal_search(const internal_node *x, const Key &k, std::true_type) const {
+	return btree_fast_search<Upper>(x->key(0), x->count, k);
+  }
+  template<bool Upper>
+  size_type internal_search(const internal_node *x, const Key &k, std::false_type) const {
+	return binary_search<Upper>(x->count, k, [x](size_type i) -> const Key & { return *x->key(i); });
+  }
+  template<bool Upper>
+  size_type leaf_search(const leaf_node *x, const Key &k, std::true_type, std::true_type) const {
+	return btree_fast_search<Upper>(reinterpret_cast<const Key *>(x->slot(0)), x->count, k);
+  }
+  template<bool Upper>
+  size_type leaf_search(const leaf_node *x, const Key &k, std::true_type, std::false_type) const {
+	return btree_fast_search<Upper>(x->count, k, [x](size_type i) -> const Key & { return key(x, i); });
+  }
+  template<bool Upper, typename Contiguous>
+  size_type leaf_search(const leaf_node *x, const Key &k, std::false_type, Contiguous) const {
+	return binary_search<Upper>(x->count, k, [x](size_type i) -> const Key & { return key(x, i); });
+  }
+
+  size_type internal_lower(const internal_node *x, const Key &k) const {
+	return internal_search<false>(x, k, fast_search());
+  }
+  size_type internal_upper(const internal_node *x, const Key &k) const {
+	return internal_search<true>(x, k, fast_search());
+  }
+  size_type leaf_lower(const leaf_node *x, const Key &k) const {
+	return leaf_search<false>(x, k, fast_search(), contiguous_leaf_keys());
+  }
+  size_type leaf_upper(const leaf_node *x, const Key &k) const {
+	return leaf_search<true>(x, k, fast_search(), contiguous_leaf_keys());
+  }
+
+  /* 下标位于叶节点尾后时移到下一个叶节点的开头，使之与 operator++ 的结果一致 */
+  static iterator normalize(leaf_node *x, size_type pos) {
+	if (pos == x->count && x->next != nullptr)
+	  return iterator(x->next, 0);
+	return iterator(x, pos);
+  }
+  static void set_child(internal_node *p, size_type i, base_ptr child) {
+	p->children[i] = child;
+	child->parent = p;
+	child->position = static_cast<unsigned short>(i);
+  }
+
+  void split_child(internal_node *p, size_type i);
+  leaf_node *descend_for_insert(const Key &k, bool upper);
+  iterator insert_into_leaf(leaf_node *x, size_type pos, const value_type &v);
+  iterator erase_aux(leaf_node *x, size_type pos);
+  void remove_from_internal(internal_node *p, size_type key_index, size_type child_index);
+  void merge_internal(internal_node *left, size_type key_index);
+  void rebalance_internal(internal_node *p);
+  base_ptr copy_aux(const base_ptr x, leaf_node *&last);
+  bool verify_aux(const base_ptr x, const Key *lo, const Key *hi, int depth, int &leaf_depth) const;
+
+ public:
+  explicit btree(const Compare &comp = Compare())
+	  : root(nullptr), leftmost(nullptr), rightmost(nullptr), node_count(0), key_compare(comp) {}
+  btree(const btree &rhs)
+	  : root(nullptr), leftmost(nullptr), rightmost(nullptr), node_count(0), key_compare(rhs.key_compare) {
+	if (rhs.root != nullptr) {
+	  leaf_node *last = nullptr;
+	  root = copy_aux(rhs.root, last);
+	  base_ptr x = root;
+	  while (!x->leaf) x = as_internal(x)->children[0];
+	  leftmost = as_leaf(x);
+	  rightmost = last;
+	  node_count = rhs.node_count;
+	}
+  }
+  btree(btree &&rhs) noexcept
+	  : root(rhs.root), leftmost(rhs.leftmost), rightmost(rhs.rightmost), node_count(rhs.node_count),
+		key_compare(rhs.key_compare) {
+	rhs.root = nullptr;
+	rhs.leftmost = rhs.rightmost = nullptr;
+	rhs.node_count = 0;
+  }
+  ~btree() { clear(); }
+
+  btree &operator=(const btree &rhs) {
+	if (this != &rhs) {
+	  btree tmp(rhs);
+	  swap(tmp);
+	}
+	return *this;
+  }
+  btree &operator=(btree &&rhs) noexcept {
+	if (this != &rhs) {
+	  clear();
+	  swap(rhs);
+	}
+	return *this;
+  }
+
+ public:
+  Compare key_comp() const { return key_compare; }
+
+  /* iterator 相关操作 */
+  iterator begin() noexcept { return iterator(leftmost, 0); }
+  const_iterator begin() const noexcept { return const_iterator(leftmost, 0); }
+  iterator end() noexcept { return iterator(rightmost, rightmost ? rightmost->count : 0); }
+  const_iterator end() const noexcept { return const_iterator(rightmost, rightmost ? rightmost->count : 0); }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+  const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+  const_reverse_iterator crend() const noexcept { return rend(); }
+
+  /* capacity 相关操作 */
+  bool empty() const noexcept { return node_count == 0; }
+  size_type size() const noexcept { return node_count; }
+  size_type max_size() const noexcept { return static_cast<size_type>(-1); }
+  void swap(btree &rhs) noexcept {
+	std::swap(root, rhs.root);
+	std::swap(leftmost, rhs.leftmost);
+	std::swap(rightmost, rhs.rightmost);
+	std::swap(node_count, rhs.node_count);
+	std::swap(key_compare, rhs.key_compare);
+  }
+
+  /* container 相关操作，hint 版本与 rb_tree 的接口一致，但不使用 position */
+  std::pair<iterator, bool> insert_unique(const value_type &value);
+  iterator insert_equal(const value_type &value);
+  iterator insert_unique(iterator, const value_type &value) { return insert_unique(value).first; }
+  iterator insert_equal(iterator, const value_type &value) { return insert_equal(value); }
+  template<typename InputIterator>
+  void insert_unique(InputIterator first, InputIterator last) {
+	for (; first != last; ++first)
+	  insert_unique(*first);
+  }
+  template<typename InputIterator>
+  void insert_equal(InputIterator first, InputIterator last) {
+	for (; first != last; ++first)
+	  insert_equal(*first);
+  }
+
+  iterator erase(iterator position) { return erase_aux(position.node, position.position); }
+  size_type erase(const key_type &x);
+  iterator erase(iterator first, iterator last);
+  void clear() {
+	if (root != nullptr) {
+	  destroy_node(root);
+	  root = nullptr;
+	  leftmost = rightmost = nullptr;
+	  node_count = 0;
+	}
+  }
+
+  iterator find(const key_type &k);
+  const_iterator find(const key_type &k) const;
+  size_type count(const key_type &k) const;
+  iterator lower_bound(const key_type &k);
+  const_iterator lower_bound(const key_type &k) const {
+	return const_cast<btree *>(this)->lower_bound(k);
+  }
+  iterator upper_bound(const key_type &k);
+  const_iterator upper_bound(const key_type &k) const {
+	return const_cast<btree *>(this)->upper_bound(k);
+  }
+  std::pair<iterator, iterator> equal_range(const key_type &k) {
+	return std::pair<iterator, iterator>(lower_bound(k), upper_bound(k));
+  }
+  std::pair<const_iterator, const_iterator> equal_range(const key_type &k) const {
+	return std::pair<const_iterator, const_iterator>(lower_bound(k), upper_bound(k));
+  }
+
+  /* 检查 B+ 树的性质：键值有序且不越过分隔键值、非根节点至少半满、叶节点等深、叶节点链表与元素个数正确 */
+  bool btree_verify() const;
+}; // class btree end
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+inline bool operator==(const btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes> &lhs,
+					   const btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes> &rhs) {
+  return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+inline bool operator<(const btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes> &lhs,
+					  const btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes> &rhs) {
+  return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+inline void swap(btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes> &lhs,
+				 btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::destroy_node(base_ptr x) {
+  if (x->leaf) {
+	leaf_node *l = as_leaf(x);
+	for (size_type i = 0; i < l->count; ++i)
+	  destroy(l->slot(i));
+	leaf_allocator::deallocate(l);
+  } else {
+	internal_node *p = as_internal(x);
+	for (size_type i = 0; i <= p->count; ++i)
+	  destroy_node(p->children[i]);
+	for (size_type i = 0; i < p->count; ++i)
+	  destroy(p->key(i));
+	internal_allocator::deallocate(p);
+  }
+}
+
+/* 将 p 已满的第 i 个孩子分裂为两个节点，后一半移入新节点，并在 p 中插入两者之间的分隔键值
+ * 叶节点以后一半的第一个键值的副本作为分隔键值，内部节点则将中间的键值上移 */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::split_child(internal_node *p, size_type i) {
+  base_ptr child = p->children[i];
+  base_ptr sibling;
+  if (child->leaf) {
+	leaf_node *l = as_leaf(child);
+	size_type mid = l->count / 2;
+	// 先复制分隔键值，复制失败时树保持不变
+	Key separator(key(l, mid));
+	leaf_node *r = create_leaf();
+	for (size_type j = mid; j < l->count; ++j) {
+	  construct(r->slot(j - mid), std::move(*l->slot(j)));
+	  destroy(l->slot(j));
+	}
+	r->count = static_cast<unsigned short>(l->count - mid);
+	l->count = static_cast<unsigned short>(mid);
+	r->next = l->next;
+	r->prev = l;
+	if (l->next != nullptr) l->next->prev = r;
+	else rightmost = r;
+	l->next = r;
+	// 为分隔键值腾出位置
+	for (size_type j = p->count; j > i; --j) {
+	  construct(p->key(j), std::move(*p->key(j - 1)));
+	  destroy(p->key(j - 1));
+	}
+	construct(p->key(i), std::move(separator));
+	sibling = r;
+  } else {
+	internal_node *l = as_internal(child);
+	internal_node *r = create_internal();
+	size_type mid = l->count / 2;
+	for (size_type j = p->count; j > i; --j) {
+	  construct(p->key(j), std::move(*p->key(j - 1)));
+	  destroy(p->key(j - 1));
+	}
+	construct(p->key(i), std::move(*l->key(mid)));
+	destroy(l->key(mid));
+	for (size_type j = mid + 1; j < l->count; ++j) {
+	  construct(r->key(j - mid - 1), std::move(*l->key(j)));
+	  destroy(l->key(j));
+	}
+	for (size_type j = mid + 1; j <= l->count; ++j)
+	  set_child(r, j - mid - 1, l->children[j]);
+	r->count = static_cast<unsigned short>(l->count - mid - 1);
+	l->count = static_cast<unsigned short>(mid);
+	sibling = r;
+  }
+  for (size_type j = p->count + 1; j > i + 1; --j)
+	set_child(p, j, p->children[j - 1]);
+  set_child(p, i + 1, sibling);
+  ++p->count;
+}
+
+/* 自顶向下找到 k 应插入的叶节点，途中分裂已满的节点，使分裂产生的分隔键值总能放入父节点
+ * upper 为 true 时插入到相等键值之后（insert_equal），否则插入到其之前 */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::leaf_node *
+btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::descend_for_insert(const Key &k, bool upper) {
+  if (root == nullptr) {
+	leaf_node *l = create_leaf();
+	root = leftmost = rightmost = l;
+	return l;
+  }
+  if (is_full(root)) {
+	internal_node *r = create_internal();
+	set_child(r, 0, root);
+	root = r;
+	try {
+	  split_child(r, 0);
+	} catch (...) {
+	  root = r->children[0];
+	  root->parent = nullptr;
+	  internal_allocator::deallocate(r);
+	  throw;
+	}
+  }
+  base_ptr x = root;
+  while (!x->leaf) {
+	internal_node *p = as_internal(x);
+	size_type i = upper ? internal_upper(p, k) : internal_lower(p, k);
+	if (is_full(p->children[i])) {
+	  split_child(p, i);
+	  if (upper ? !key_compare(k, *p->key(i)) : key_compare(*p->key(i), k))
+		++i;
+	}
+	x = p->children[i];
+  }
+  return as_leaf(x);
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::iterator
+btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::insert_into_leaf(leaf_node *x, size_type pos,
+																				const value_type &v) {
+  for (size_type j = x->count; j > pos; --j) {
+	construct(x->slot(j), std::move(*x->slot(j - 1)));
+	destroy(x->slot(j - 1));
+  }
+  try {
+	construct(x->slot(pos), v);
+  } catch (...) {
+	for (size_type j = pos; j < x->count; ++j) {
+	  construct(x->slot(j), std::move(*x->slot(j + 1)));
+	  destroy(x->slot(j + 1));
+	}
+	throw;
+  }
+  ++x->count;
+  ++node_count;
+  return iterator(x, pos);
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+std::pair<typename btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::iterator, bool>
+btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::insert_unique(const value_type &value) {
+  const Key &k = KeyOfValue()(value);
+  // 先查找，键值已存在时不必分裂沿途的节点
+  iterator it = lower_bound(k);
+  if (it != end() && !key_compare(k, KeyOfValue()(*it)))
+	return std::pair<iterator, bool>(it, false);
+  leaf_node *x = descend_for_insert(k, false);
+  return std::pair<iterator, bool>(insert_into_leaf(x, leaf_lower(x, k), value), true);
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::iterator
+btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::insert_equal(const value_type &value) {
+  const Key &k = KeyOfValue()(value);
+  leaf_node *x = descend_for_insert(k, true);
+  return insert_into_leaf(x, leaf_upper(x, k), value);
+}
+
+/* 删除内部节点 p 的第 key_index 个键值与第 child_index 个孩子 */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::remove_from_internal(internal_node *p,
+																						 size_type key_index,
+																						 size_type child_index) {
+  destroy(p->key(key_index));
+  for (size_type j = key_index + 1; j < p->count; ++j) {
+	construct(p->key(j - 1), std::move(*p->key(j)));
+	destroy(p->key(j));
+  }
+  for (size_type j = child_index + 1; j <= p->count; ++j)
+	set_child(p, j - 1, p->children[j]);
+  --p->count;
+}
+
+/* 将 left 的右兄弟连同父节点中两者之间的分隔键值并入 left */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::merge_internal(internal_node *left,
+																				   size_type key_index) {
+  internal_node *p = as_internal(left->parent);
+  internal_node *right = as_internal(p->children[key_index + 1]);
+  size_type n = left->count;
+  construct(left->key(n), std::move(*p->key(key_index)));
+  for (size_type j = 0; j < right->count; ++j) {
+	construct(left->key(n + 1 + j), std::move(*right->key(j)));
+	destroy(right->key(j));
+  }
+  for (size_type j = 0; j <= right->count; ++j)
+	set_child(left, n + 1 + j, right->children[j]);
+  left->count = static_cast<unsigned short>(n + 1 + right->count);
+  remove_from_internal(p, key_index, key_index + 1);
+  internal_allocator::deallocate(right);
+}
+
+/* 自 p 向上修复不足半满的内部节点：先向兄弟节点借用（经由父节点中的分隔键值旋转），否则与之合并 */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+void btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::rebalance_internal(internal_node *p) {
+  for (;;) {
+	if (p == root) {
+	  if (p->count == 0) {
+		root = p->children[0];
+		root->parent = nullptr;
+		root->position = 0;
+		internal_allocator::deallocate(p);
+	  }
+	  return;
+	}
+	if (p->count >= internal_min)
+	  return;
+	internal_node *g = as_internal(p->parent);
+	size_type i = p->position;
+	internal_node *left = i > 0 ? as_internal(g->children[i - 1]) : nullptr;
+	internal_node *right = i < g->count ? as_internal(g->children[i + 1]) : nullptr;
+	if (left != nullptr && left->count > internal_min) {
+	  for (size_type j = p->count; j > 0; --j) {
+		construct(p->key(j), std::move(*p->key(j - 1)));
+		destroy(p->key(j - 1));
+	  }
+	  for (size_type j = p->count + 1; j > 0; --j)
+		set_child(p, j, p->children[j - 1]);
+	  construct(p->key(0), std::move(*g->key(i - 1)));
+	  set_child(p, 0, left->children[left->count]);
+	  *g->key(i - 1) = std::move(*left->key(left->count - 1));
+	  destroy(left->key(left->count - 1));
+	  --left->count;
+	  ++p->count;
+	  return;
+	}
+	if (right != nullptr && right->count > internal_min) {
+	  construct(p->key(p->count), std::move(*g->key(i)));
+	  set_child(p, p->count + 1, right->children[0]);
+	  *g->key(i) = std::move(*right->key(0));
+	  for (size_type j = 1; j < right->count; ++j) {
+		construct(right->key(j - 1), std::move(*right->key(j)));
+		destroy(right->key(j));
+	  }
+	  destroy(right->key(right->count - 1));
+	  for (size_type j = 1; j <= right->count; ++j)
+		set_child(right, j - 1, right->children[j]);
+	  --right->count;
+	  ++p->count;
+	  return;
+	}
+	if (left != nullptr)
+	  merge_internal(left, i - 1);
+	else
+	  merge_internal(p, i);
+	p = g;
+  }
+}
+
+/* 删除叶节点 x 中下标为 pos 的元素，返回指向下一个元素的迭代器
+ * 叶节点不足半满时的借用与合并都会搬移元素，因此随之更新下一个元素所在的位置 */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::iterator
+btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::erase_aux(leaf_node *x, size_type pos) {
+  destroy(x->slot(pos));
+  for (size_type j = pos + 1; j < x->count; ++j) {
+	construct(x->slot(j - 1), std::move(*x->slot(j)));
+	destroy(x->slot(j));
+  }
+  --x->count;
+  --node_count;
+
+  if (x == root) {
+	if (x->count == 0) {
+	  leaf_allocator::deallocate(x);
+	  root = leftmost = rightmost = nullptr;
+	  return end();
+	}
+	return normalize(x, pos);
+  }
+  if (x->count >= leaf_min)
+	return normalize(x, pos);
+
+  internal_node *p = as_internal(x->parent);
+  size_type i = x->position;
+  leaf_node *left = i > 0 ? as_leaf(p->children[i - 1]) : nullptr;
+  leaf_node *right = i < p->count ? as_leaf(p->children[i + 1]) : nullptr;
+  if (left != nullptr && left->count > leaf_min) {
+	for (size_type j = x->count; j > 0; --j) {
+	  construct(x->slot(j), std::move(*x->slot(j - 1)));
+	  destroy(x->slot(j - 1));
+	}
+	construct(x->slot(0), std::move(*left->slot(left->count - 1)));
+	destroy(left->slot(left->count - 1));
+	--left->count;
+	++x->count;
+	*p->key(i - 1) = key(x, 0);
+	return normalize(x, pos + 1);
+  }
+  if (right != nullptr && right->count > leaf_min) {
+	construct(x->slot(x->count), std::move(*right->slot(0)));
+	for (size_type j = 1; j < right->count; ++j) {
+	  construct(right->slot(j - 1), std::move(*right->slot(j)));
+	  destroy(right->slot(j));
+	}
+	destroy(right->slot(right->count - 1));
+	--right->count;
+	++x->count;
+	*p->key(i) = key(right, 0);
+	return normalize(x, pos);
+  }
+
+  // 与兄弟节点合并，右侧的节点并入左侧
+  leaf_node *target = x;
+  if (left != nullptr) {
+	pos += left->count;
+	target = left;
+	right = x;
+	--i;
+  }
+  for (size_type j = 0; j < right->count; ++j) {
+	construct(target->slot(target->count + j), std::move(*right->slot(j)));
+	destroy(right->slot(j));
+  }
+  target->count = static_cast<unsigned short>(target->count + right->count);
+  target->next = right->next;
+  if (right->next != nullptr) right->next->prev = target;
+  else rightmost = target;
+  remove_from_internal(p, i, i + 1);
+  leaf_allocator::deallocate(right);
+  rebalance_internal(p);
+  return normalize(target, pos);
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::size_type
+btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::erase(const Key &x) {
+  iterator it = lower_bound(x);
+  size_type n = 0;
+  while (it != end() && !key_compare(x, KeyOfValue()(*it))) {
+	it = erase(it);
+	++n;
+  }
+  return n;
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::iterator
+btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::erase(iterator first, iterator last) {
+  if (first == begin() && last == end()) {
+	clear();
+	return end();
+  }
+  // 删除会搬移元素，last 随之失效，因此先数出个数
+  size_type n = 0;
+  for (iterator it = first; it != last; ++it) ++n;
+  while (n-- > 0)
+	first = erase(first);
+  return first;
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::iterator
+btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::lower_bound(const Key &k) {
+  if (root == nullptr)
+	return end();
+  base_ptr x = root;
+  while (!x->leaf) {
+	internal_node *p = as_internal(x);
+	x = p->children[internal_lower(p, k)];
+  }
+  return normalize(as_leaf(x), leaf_lower(as_leaf(x), k));
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::iterator
+btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::upper_bound(const Key &k) {
+  if (root == nullptr)
+	return end();
+  base_ptr x = root;
+  while (!x->leaf) {
+	internal_node *p = as_internal(x);
+	x = p->children[internal_upper(p, k)];
+  }
+  return normalize(as_leaf(x), leaf_upper(as_leaf(x), k));
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::iterator
+btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::find(const Key &k) {
+  iterator it = lower_bound(k);
+  return (it == end() || key_compare(k, KeyOfValue()(*it))) ? end() : it;
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::const_iterator
+btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::find(const Key &k) const {
+  return const_cast<btree *>(this)->find(k);
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::size_type
+btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::count(const Key &k) const {
+  size_type n = 0;
+  for (const_iterator it = lower_bound(k); it != end() && !key_compare(k, KeyOfValue()(*it)); ++it)
+	++n;
+  return n;
+}
+
+/* 复制以 x 为根的子树，叶节点按中序经 last 串成链表 */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+typename btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::base_ptr
+btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::copy_aux(const base_ptr x, leaf_node *&last) {
+  if (x->leaf) {
+	const leaf_node *src = as_leaf(x);
+	leaf_node *l = create_leaf();
+	try {
+	  for (; l->count < src->count; ++l->count)
+		construct(l->slot(l->count), *src->slot(l->count));
+	} catch (...) {
+	  destroy_node(l);
+	  throw;
+	}
+	l->prev = last;
+	if (last != nullptr) last->next = l;
+	last = l;
+	return l;
+  }
+  const internal_node *src = as_internal(x);
+  internal_node *p = create_internal();
+  size_type copied = 0; // 已复制的孩子个数
+  try {
+	set_child(p, 0, copy_aux(src->children[0], last));
+	copied = 1;
+	while (p->count < src->count) {
+	  construct(p->key(p->count), *src->key(p->count));
+	  ++p->count;
+	  set_child(p, copied, copy_aux(src->children[copied], last));
+	  ++copied;
+	}
+  } catch (...) {
+	for (size_type i = 0; i < copied; ++i)
+	  destroy_node(p->children[i]);
+	for (size_type i = 0; i < p->count; ++i)
+	  destroy(p->key(i));
+	internal_allocator::deallocate(p);
+	throw;
+  }
+  return p;
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+bool btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::verify_aux(const base_ptr x, const Key *lo,
+																			   const Key *hi, int depth,
+																			   int &leaf_depth) const {
+  if (x != root && x->count < (x->leaf ? leaf_min : internal_min))
+	return false;
+  if (x->leaf) {
+	const leaf_node *l = as_leaf(x);
+	if (leaf_depth < 0) leaf_depth = depth;
+	if (leaf_depth != depth) return false;
+	for (size_type i = 0; i < l->count; ++i) {
+	  if (i > 0 && key_compare(key(l, i), key(l, i - 1))) return false;
+	  if (lo != nullptr && key_compare(key(l, i), *lo)) return false;
+	  if (hi != nullptr && key_compare(*hi, key(l, i))) return false;
+	}
+	return true;
+  }
+  const internal_node *p = as_internal(x);
+  for (size_type i = 0; i <= p->count; ++i) {
+	if (p->children[i]->parent != x || p->children[i]->position != i) return false;
+	if (i > 0 && i < p->count && key_compare(*p->key(i), *p->key(i - 1))) return false;
+	const Key *clo = i == 0 ? lo : p->key(i - 1);
+	const Key *chi = i == p->count ? hi : p->key(i);
+	if (!verify_aux(p->children[i], clo, chi, depth + 1, leaf_depth)) return false;
+  }
+  return true;
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, size_t NodeBytes>
+bool btree<Key, Value, KeyOfValue, Compare, Allocator, NodeBytes>::btree_verify() const {
+  if (root == nullptr)
+	return node_count == 0 && leftmost == nullptr && rightmost == nullptr;
+  int leaf_depth = -1;
+  if (root->parent != nullptr || !verify_aux(root, nullptr, nullptr, 0, leaf_depth))
+	return false;
+  size_type n = 0;
+  const leaf_node *prev = nullptr;
+  for (const leaf_node *l = leftmost; l != nullptr; prev = l, l = l->next) {
+	if (l->prev != prev) return false;
+	n += l->count;
+  }
+  return prev == rightmost && n == node_count;
+}
+
+} // namespace tinystl
+
+#endif //TINYSTL__BTREE_H_
@@ -0,0 +1,202 @@
+//
+// Created by polarnight on 26-10-19, 下午9:20.
+//
+
+#ifndef TINYSTL__BTREE_MAP_H_
+#define TINYSTL__BTREE_MAP_H_
+
+/* <btree_map.h> 实现了 btree_map/btree_multimap
+ * 接口与 <map.h> 的 map/multimap 一致，底层改用 <btree.h> 的 B+ 树：元素连续存放，查找与顺序扫描的 cache miss 更少。
+ * 区别在于插入与删除会使所有迭代器失效，erase 返回指向下一个元素的迭代器。
+ * NodeBytes 为每个节点的字节数，缺省 256 */
+
+#include <functional>
+
+#include "btree.h"
+
+namespace tinystl {
+template<typename Key, typename T, typename Compare = std::less<Key>, typename Allocator = Alloc,
+		 size_t NodeBytes = 256>
+class btree_map {
+ public:
+  using key_type = Key;
+  using data_type = T;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using key_compare = Compare;
+
+  class value_compare {
+	friend class btree_map<Key, T, Compare, Allocator, NodeBytes>;
+   private:
+	Compare comp;
+	explicit value_compare(Compare c) : comp(c) {}
+   public:
+	bool operator()(const value_type &lhs, const value_type &rhs) const { return comp(lhs.first, rhs.first); }
+  };
+
+ private:
+  using base_ptr = btree<key_type, value_type, std::_Select1st<value_type>, key_compare, Allocator, NodeBytes>;
+  base_ptr tree;
+
+ public:
+  using pointer = typename base_ptr::pointer;
+  using const_pointer = typename base_ptr::const_pointer;
+  using reference = typename base_ptr::reference;
+  using const_reference = typename base_ptr::const_reference;
+  using iterator = typename base_ptr::iterator;
+  using const_iterator = typename base_ptr::const_iterator;
+  using difference_type = typename base_ptr::difference_type;
+  using size_type = typename base_ptr::size_type;
+
+  btree_map() : tree(Compare()) {}
+  explicit btree_map(const Compare &comp) : tree(comp) {}
+  template<typename InputIterator>
+  btree_map(InputIterator first, InputIterator last) : tree(Compare()) { tree.insert_unique(first, last); }
+  template<typename InputIterator>
+  btree_map(InputIterator first, InputIterator last, const Compare &comp) : tree(comp) {
+	tree.insert_unique(first, last);
+  }
+  btree_map(const btree_map &x) : tree(x.tree) {}
+  btree_map &operator=(const btree_map &x) {
+	tree = x.tree;
+	return *this;
+  }
+
+  /* accessor 相关操作 */
+  key_compare key_comp() const { return tree.key_comp(); }
+  value_compare value_comp() const { return value_compare(key_comp()); }
+  iterator begin() noexcept { return tree.begin(); }
+  const_iterator begin() const noexcept { return tree.begin(); }
+  iterator end() noexcept { return tree.end(); }
+  const_iterator end() const noexcept { return tree.end(); }
+  bool empty() const noexcept { return tree.empty(); }
+  size_type size() const noexcept { return tree.size(); }
+  size_type max_size() const noexcept { return tree.max_size(); }
+  void swap(btree_map &x) noexcept { tree.swap(x.tree); }
+
+  /* container 相关操作 */
+  std::pair<iterator, bool> insert(const value_type &x) { return tree.insert_unique(x); }
+  iterator insert(iterator position, const value_type &x) { return tree.insert_unique(position, x); }
+  template<typename InputIterator>
+  void insert(InputIterator first, InputIterator last) { tree.insert_unique(first, last); }
+  iterator erase(iterator position) { return tree.erase(position); }
+  size_type erase(const key_type &x) { return tree.erase(x); }
+  iterator erase(iterator first, iterator last) { return tree.erase(first, last); }
+  void clear() { tree.clear(); }
+
+  /* operator 相关操作 */
+  iterator find(const key_type &x) { return tree.find(x); }
+  const_iterator find(const key_type &x) const { return tree.find(x); }
+  size_type count(const key_type &x) const { return tree.count(x); }
+  iterator lower_bound(const key_type &x) { return tree.lower_bound(x); }
+  const_iterator lower_bound(const key_type &x) const { return tree.lower_bound(x); }
+  iterator upper_bound(const key_type &x) { return tree.upper_bound(x); }
+  const_iterator upper_bound(const key_type &x) const { return tree.upper_bound(x); }
+  std::pair<iterator, iterator> equal_range(const key_type &x) { return tree.equal_range(x); }
+  std::pair<const_iterator, const_iterator> equal_range(const key_type &x) const { return tree.equal_range(x); }
+  friend bool operator==(const btree_map &lhs, const btree_map &rhs) { return lhs.tree == rhs.tree; }
+  friend bool operator<(const btree_map &lhs, const btree_map &rhs) { return lhs.tree < rhs.tree; }
+  friend bool operator!=(const btree_map &lhs, const btree_map &rhs) { return !(lhs.tree == rhs.tree); }
+}; // class btree_map end
+
+template<typename Key, typename T, typename Compare, typename Allocator, size_t NodeBytes>
+inline void swap(btree_map<Key, T, Compare, Allocator, NodeBytes> &lhs,
+				 btree_map<Key, T, Compare, Allocator, NodeBytes> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+/********************************************************************************************************************/
+
+template<typename Key, typename T, typename Compare = std::less<Key>, typename Allocator = Alloc,
+		 size_t NodeBytes = 256>
+class btree_multimap {
+ public:
+  using key_type = Key;
+  using data_type = T;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using key_compare = Compare;
+
+  class value_compare {
+	friend class btree_multimap<Key, T, Compare, Allocator, NodeBytes>;
+   private:
+	Compare comp;
+	explicit value_compare(Compare c) : comp(c) {}
+   public:
+	bool operator()(const value_type &lhs, const value_type &rhs) const { return comp(lhs.first, rhs.first); }
+  };
+
+ private:
+  using base_ptr = btree<key_type, value_type, std::_Select1st<value_type>, key_compare, Allocator, NodeBytes>;
+  base_ptr tree;
+
+ public:
+  using pointer = typename base_ptr::pointer;
+  using const_pointer = typename base_ptr::const_pointer;
+  using reference = typename base_ptr::reference;
+  using const_reference = typename base_ptr::const_reference;
+  using iterator = typename base_ptr::iterator;
+  using const_iterator = typename base_ptr::const_iterator;
+  using difference_type = typename base_ptr::difference_type;
+  using size_type = typename base_ptr::size_type;
+
+  btree_multimap() : tree(Compare()) {}
+  explicit btree_multimap(const Compare &comp) : tree(comp) {}
+  template<typename InputIterator>
+  btree_multimap(InputIterator first, InputIterator last) : tree(Compare()) { tree.insert_equal(first, last); }
+  template<typename InputIterator>
+  btree_multimap(InputIterator first, InputIterator last, const Compare &comp) : tree(comp) {
+	tree.insert_equal(first, last);
+  }
+  btree_multimap(const btree_multimap &x) : tree(x.tree) {}
+  btree_multimap &operator=(const btree_multimap &x) {
+	tree = x.tree;
+	return *this;
+  }
+
+  /* accessor 相关操作 */
+  key_compare key_comp() const { return tree.key_comp(); }
+  value_compare value_comp() const { return value_compare(key_comp()); }
+  iterator begin() noexcept { return tree.begin(); }
+  const_iterator begin() const noexcept { return tree.begin(); }
+  iterator end() noexcept { return tree.end(); }
+  const_iterator end() const noexcept { return tree.end(); }
+  bool empty() const noexcept { return tree.empty(); }
+  size_type size() const noexcept { return tree.size(); }
+  size_type max_size() const noexcept { return tree.max_size(); }
+  void swap(btree_multimap &x) noexcept { tree.swap(x.tree); }
+
+  /* container 相关操作 */
+  iterator insert(const value_type &x) { return tree.insert_equal(x); }
+  iterator insert(iterator position, const value_type &x) { return tree.insert_equal(position, x); }
+  template<typename InputIterator>
+  void insert(InputIterator first, InputIterator last) { tree.insert_equal(first, last); }
+  iterator erase(iterator position) { return tree.erase(position); }
+  size_type erase(const key_type &x) { return tree.erase(x); }
+  iterator erase(iterator first, iterator last) { return tree.erase(first, last); }
+  void clear() { tree.clear(); }
+
+  /* operator 相关操作 */
+  iterator find(const key_type &x) { return tree.find(x); }
+  const_iterator find(const key_type &x) const { return tree.find(x); }
+  size_type count(const key_type &x) const { return tree.count(x); }
+  iterator lower_bound(const key_type &x) { return tree.lower_bound(x); }
+  const_iterator lower_bound(const key_type &x) const { return tree.lower_bound(x); }
+  iterator upper_bound(const key_type &x) { return tree.upper_bound(x); }
+  const_iterator upper_bound(const key_type &x) const { return tree.upper_bound(x); }
+  std::pair<iterator, iterator> equal_range(const key_type &x) { return tree.equal_range(x); }
+  std::pair<const_iterator, const_iterator> equal_range(const key_type &x) const { return tree.equal_range(x); }
+  friend bool operator==(const btree_multimap &lhs, const btree_multimap &rhs) { return lhs.tree == rhs.tree; }
+  friend bool operator<(const btree_multimap &lhs, const btree_multimap &rhs) { return lhs.tree < rhs.tree; }
+  friend bool operator!=(const btree_multimap &lhs, const btree_multimap &rhs) { return !(lhs.tree == rhs.tree); }
+}; // class btree_multimap end
+
+template<typename Key, typename T, typename Compare, typename Allocator, size_t NodeBytes>
+inline void swap(btree_multimap<Key, T, Compare, Allocator, NodeBytes> &lhs,
+				 btree_multimap<Key, T, Compare, Allocator, NodeBytes> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+} // namespace tinystl
+
+#endif //TINYSTL__BTREE_MAP_H_
@@ -0,0 +1,188 @@
+//
+// Created by polarnight on 26-10-19, 下午9:05.
+//
+
+#ifndef TINYSTL__BTREE_SET_H_
+#define TINYSTL__BTREE_SET_H_
+
+/* <btree_set.h> 实现了 btree_set/btree_multiset
+ * 接口与 <set.h> 的 set/multiset 一致，底层改用 <btree.h> 的 B+ 树：元素连续存放，查找与顺序扫描的 cache miss 更少。
+ * 区别在于插入与删除会使所有迭代器失效，erase 返回指向下一个元素的迭代器。
+ * NodeBytes 为每个节点的字节数，缺省 256 */
+
+#include <functional>
+
+#include "btree.h"
+
+namespace tinystl {
+template<typename Key, typename Compare = std::less<Key>, typename Allocator = Alloc, size_t NodeBytes = 256>
+class btree_set {
+ public:
+  using key_type = Key;
+  using value_type = Key;
+  using key_compare = Compare;
+  using value_compare = Compare;
+
+ private:
+  using base_ptr = btree<key_type, value_type, std::_Identity<value_type>, key_compare, Allocator, NodeBytes>;
+  base_ptr tree;
+
+ public:
+  using pointer = typename base_ptr::const_pointer;
+  using const_pointer = typename base_ptr::const_pointer;
+  using reference = typename base_ptr::const_reference;
+  using const_reference = typename base_ptr::const_reference;
+  using iterator = typename base_ptr::const_iterator;
+  using const_iterator = typename base_ptr::const_iterator;
+  using difference_type = typename base_ptr::difference_type;
+  using size_type = typename base_ptr::size_type;
+
+  btree_set() : tree(Compare()) {}
+  explicit btree_set(const Compare &comp) : tree(comp) {}
+  template<typename InputIterator>
+  btree_set(InputIterator first, InputIterator last) : tree(Compare()) { tree.insert_unique(first, last); }
+  template<typename InputIterator>
+  btree_set(InputIterator first, InputIterator last, const Compare &comp) : tree(comp) {
+	tree.insert_unique(first, last);
+  }
+  btree_set(const btree_set &x) : tree(x.tree) {}
+  btree_set &operator=(const btree_set &x) {
+	tree = x.tree;
+	return *this;
+  }
+
+  /* accessor 相关操作 */
+  key_compare key_comp() const { return tree.key_comp(); }
+  value_compare value_comp() const { return key_comp(); }
+  iterator begin() const { return tree.begin(); }
+  iterator end() const { return tree.end(); }
+  bool empty() const { return tree.empty(); }
+  size_type size() const { return tree.size(); }
+  size_type max_size() const { return tree.max_size(); }
+  void swap(btree_set &x) { tree.swap(x.tree); }
+
+  /* container 相关操作 */
+  std::pair<iterator, bool> insert(const value_type &x) {
+	std::pair<typename base_ptr::iterator, bool> p = tree.insert_unique(x);
+	return std::pair<iterator, bool>(p.first, p.second);
+  }
+  iterator insert(iterator position, const value_type &x) {
+	using base_iterator = typename base_ptr::iterator;
+	return tree.insert_unique(base_iterator(position), x);
+  }
+  template<typename InputIterator>
+  void insert(InputIterator first, InputIterator last) { tree.insert_unique(first, last); }
+  iterator erase(iterator position) {
+	using base_iterator = typename base_ptr::iterator;
+	return tree.erase(base_iterator(position));
+  }
+  size_type erase(const key_type &x) { return tree.erase(x); }
+  iterator erase(iterator first, iterator last) {
+	using base_iterator = typename base_ptr::iterator;
+	return tree.erase(base_iterator(first), base_iterator(last));
+  }
+  void clear() { tree.clear(); }
+
+  /* operator 相关操作 */
+  iterator find(const key_type &x) const { return tree.find(x); }
+  size_type count(const key_type &x) const { return tree.count(x); }
+  iterator lower_bound(const key_type &x) const { return tree.lower_bound(x); }
+  iterator upper_bound(const key_type &x) const { return tree.upper_bound(x); }
+  std::pair<iterator, iterator> equal_range(const key_type &x) const { return tree.equal_range(x); }
+  friend bool operator==(const btree_set &lhs, const btree_set &rhs) { return lhs.tree == rhs.tree; }
+  friend bool operator<(const btree_set &lhs, const btree_set &rhs) { return lhs.tree < rhs.tree; }
+  friend bool operator!=(const btree_set &lhs, const btree_set &rhs) { return !(lhs.tree == rhs.tree); }
+}; // class btree_set end
+
+template<typename Key, typename Compare, typename Allocator, size_t NodeBytes>
+void swap(btree_set<Key, Compare, Allocator, NodeBytes> &lhs, btree_set<Key, Compare, Allocator, NodeBytes> &rhs) {
+  lhs.swap(rhs);
+}
+
+/********************************************************************************************************************/
+
+template<typename Key, typename Compare = std::less<Key>, typename Allocator = Alloc, size_t NodeBytes = 256>
+class btree_multiset {
+ public:
+  using key_type = Key;
+  using value_type = Key;
+  using key_compare = Compare;
+  using value_compare = Compare;
+
+ private:
+  using base_ptr = btree<key_type, value_type, std::_Identity<value_type>, key_compare, Allocator, NodeBytes>;
+  base_ptr tree;
+
+ public:
+  using pointer = typename base_ptr::const_pointer;
+  using const_pointer = typename base_ptr::const_pointer;
+  using reference = typename base_ptr::const_reference;
+  using const_reference = typename base_ptr::const_reference;
+  using iterator = typename base_ptr::const_iterator;
+  using const_iterator = typename base_ptr::const_iterator;
+  using difference_type = typename base_ptr::difference_type;
+  using size_type = typename base_ptr::size_type;
+
+  btree_multiset() : tree(Compare()) {}
+  explicit btree_multiset(const Compare &comp) : tree(comp) {}
+  template<typename InputIterator>
+  btree_multiset(InputIterator first, InputIterator last) : tree(Compare()) { tree.insert_equal(first, last); }
+  template<typename InputIterator>
+  btree_multiset(InputIterator first, InputIterator last, const Compare &comp) : tree(comp) {
+	tree.insert_equal(first, last);
+  }
+  btree_multiset(const btree_multiset &x) : tree(x.tree) {}
+  btree_multiset &operator=(const btree_multiset &x) {
+	tree = x.tree;
+	return *this;
+  }
+
+  /* accessor 相关操作 */
+  key_compare key_comp() const { return tree.key_comp(); }
+  value_compare value_comp() const { return key_comp(); }
+  iterator begin() const { return tree.begin(); }
+  iterator end() const { return tree.end(); }
+  bool empty() const { return tree.empty(); }
+  size_type size() const { return tree.size(); }
+  size_type max_size() const { return tree.max_size(); }
+  void swap(btree_multiset &x) { tree.swap(x.tree); }
+
+  /* container 相关操作 */
+  iterator insert(const value_type &x) { return tree.insert_equal(x); }
+  iterator insert(iterator position, const value_type &x) {
+	using base_iterator = typename base_ptr::iterator;
+	return tree.insert_equal(base_iterator(position), x);
+  }
+  template<typename InputIterator>
+  void insert(InputIterator first, InputIterator last) { tree.insert_equal(first, last); }
+  iterator erase(iterator position) {
+	using base_iterator = typename base_ptr::iterator;
+	return tree.erase(base_iterator(position));
+  }
+  size_type erase(const key_type &x) { return tree.erase(x); }
+  iterator erase(iterator first, iterator last) {
+	using base_iterator = typename base_ptr::iterator;
+	return tree.erase(base_iterator(first), base_iterator(last));
+  }
+  void clear() { tree.clear(); }
+
+  /* operator 相关操作 */
+  iterator find(const key_type &x) const { return tree.find(x); }
+  size_type count(const key_type &x) const { return tree.count(x); }
+  iterator lower_bound(const key_type &x) const { return tree.lower_bound(x); }
+  iterator upper_bound(const key_type &x) const { return tree.upper_bound(x); }
+  std::pair<iterator, iterator> equal_range(const key_type &x) const { return tree.equal_range(x); }
+  friend bool operator==(const btree_multiset &lhs, const btree_multiset &rhs) { return lhs.tree == rhs.tree; }
+  friend bool operator<(const btree_multiset &lhs, const btree_multiset &rhs) { return lhs.tree < rhs.tree; }
+  friend bool operator!=(const btree_multiset &lhs, const btree_multiset &rhs) { return !(lhs.tree == rhs.tree); }
+}; // class btree_multiset end
+
+template<typename Key, typename Compare, typename Allocator, size_t NodeBytes>
+void swap(btree_multiset<Key, Compare, Allocator, NodeBytes> &lhs,
+		  btree_multiset<Key, Compare, Allocator, NodeBytes> &rhs) {
+  lhs.swap(rhs);
+}
+
+} // namespace tinystl
+
+#endif //TINYSTL__BTREE_SET_H_
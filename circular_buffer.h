@@ -0,0 +1,340 @@
+//
+// Created by polarnight on 26-10-19, 下午2:16.
+//
+
+#ifndef TINYSTL__CIRCULAR_BUFFER_H_
+#define TINYSTL__CIRCULAR_BUFFER_H_
+
+/* <circular_buffer.h> 实现了 circular_buffer
+ * 容量固定、存储连续的环形缓冲区，适用于滑动窗口一类 “尾端写入、头端淘汰” 的场景
+ * 与 deque 相比，它只在构造时配置一次空间，之后的 push/pop 不再触及配置器
+ * 缓冲区满时的行为由 circular_buffer_overflow 决定：overwrite 覆盖最旧的元素，reject 拒绝写入 */
+
+#include <algorithm> // for std::rotate
+#include <initializer_list>
+#include <utility> // for std::pair
+
+#include "memory.h"
+#include "iterator.h"
+
+namespace tinystl {
+enum class circular_buffer_overflow { overwrite, reject };
+
+template<typename T, typename Ref, typename Ptr>
+struct circular_buffer_iterator : public tinystl::iterator<random_access_iterator_tag, T> {
+  using iterator = circular_buffer_iterator<T, T &, T *>;
+  using const_iterator = circular_buffer_iterator<T, const T &, const T *>;
+  using self = circular_buffer_iterator;
+
+  using iterator_category = random_access_iterator_tag;
+  using value_type = T;
+  using pointer = Ptr;
+  using reference = Ref;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+
+  T *first; // 存储空间的头
+  size_type cap; // 存储空间的容量
+  size_type head; // 逻辑上第一个元素在存储空间中的下标
+  difference_type index; // iterator 所指元素的逻辑下标
+
+  circular_buffer_iterator() : first(nullptr), cap(0), head(0), index(0) {}
+  circular_buffer_iterator(T *f, size_type c, size_type h, difference_type i) : first(f), cap(c), head(h), index(i) {}
+  circular_buffer_iterator(const iterator &iter) : first(iter.first), cap(iter.cap), head(iter.head), index(iter.index) {}
+
+  /* 重载各种运算符 */
+  reference operator*() const {
+	size_type offset = head + static_cast<size_type>(index);
+	return first[offset >= cap ? offset - cap : offset];
+  }
+  pointer operator->() const { return &(operator*()); }
+  difference_type operator-(const self &x) const { return index - x.index; }
+  self &operator++() {
+	++index;
+	return *this;
+  }
+  self operator++(int) {
+	self tmp = *this;
+	++index;
+	return tmp;
+  }
+  self &operator--() {
+	--index;
+	return *this;
+  }
+  self operator--(int) {
+	self tmp = *this;
+	--index;
+	return tmp;
+  }
+  self &operator+=(difference_type n) {
+	index += n;
+	return *this;
+  }
+  self operator+(difference_type n) const { return self(first, cap, head, index + n); }
+  self &operator-=(difference_type n) {
+	index -= n;
+	return *this;
+  }
+  self operator-(difference_type n) const { return self(first, cap, head, index - n); }
+  reference operator[](difference_type n) const { return *(*this + n); }
+  bool operator==(const self &rhs) const { return index == rhs.index; }
+  bool operator!=(const self &rhs) const { return index != rhs.index; }
+  bool operator<(const self &rhs) const { return index < rhs.index; }
+}; // circular_buffer_iterator end
+
+template<typename T, typename Allocator = Alloc>
+class circular_buffer {
+ public:
+  using value_type = T;
+  using pointer = value_type *;
+  using const_pointer = const value_type *;
+  using reference = T &;
+  using const_reference = const T &;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+
+  using iterator = circular_buffer_iterator<T, T &, T *>;
+  using const_iterator = circular_buffer_iterator<T, const T &, const T *>;
+  using reverse_iterator = tinystl::reverse_iterator<iterator>;
+  using const_reverse_iterator = tinystl::reverse_iterator<const_iterator>;
+  using array_range = std::pair<pointer, size_type>;
+  using const_array_range = std::pair<const_pointer, size_type>;
+
+ protected:
+  using data_allocator = alloc<value_type, Allocator>;
+
+  pointer start; // 存储空间的头
+  size_type cap; // 存储空间的容量
+  size_type head; // 第一个元素的下标
+  size_type count; // 元素个数
+  circular_buffer_overflow policy;
+
+  /* 内部辅助函数 */
+  size_type physical(size_type n) const { // 逻辑下标转换为存储空间中的下标
+	size_type offset = head + n;
+	return offset >= cap ? offset - cap : offset;
+  }
+  void increment(size_type &n) const { if (++n == cap) n = 0; }
+  void decrement(size_type &n) const { n = (n == 0 ? cap : n) - 1; }
+  template<typename InputIterator>
+  void copy_init(InputIterator first, InputIterator last);
+
+ public:
+  explicit circular_buffer(size_type capacity,
+						   circular_buffer_overflow p = circular_buffer_overflow::overwrite)
+	  : start(data_allocator::allocate(capacity)), cap(capacity), head(0), count(0), policy(p) {}
+  circular_buffer(const circular_buffer &rhs)
+	  : start(data_allocator::allocate(rhs.cap)), cap(rhs.cap), head(0), count(0), policy(rhs.policy) {
+	copy_init(rhs.begin(), rhs.end());
+  }
+  circular_buffer(circular_buffer &&rhs) noexcept
+	  : start(rhs.start), cap(rhs.cap), head(rhs.head), count(rhs.count), policy(rhs.policy) {
+	rhs.start = nullptr;
+	rhs.cap = rhs.head = rhs.count = 0;
+  }
+  circular_buffer(std::initializer_list<value_type> rhs,
+				  circular_buffer_overflow p = circular_buffer_overflow::overwrite)
+	  : start(data_allocator::allocate(rhs.size())), cap(rhs.size()), head(0), count(0), policy(p) {
+	copy_init(rhs.begin(), rhs.end());
+  }
+  ~circular_buffer() {
+	clear();
+	data_allocator::deallocate(start, cap);
+  }
+
+  circular_buffer &operator=(const circular_buffer &rhs) {
+	if (&rhs != this) {
+	  circular_buffer tmp(rhs);
+	  swap(tmp);
+	}
+	return *this;
+  }
+  circular_buffer &operator=(circular_buffer &&rhs) noexcept {
+	swap(rhs);
+	return *this;
+  }
+
+  /* iterator 相关操作 */
+  iterator begin() noexcept { return iterator(start, cap, head, 0); }
+  const_iterator begin() const noexcept { return const_iterator(start, cap, head, 0); }
+  iterator end() noexcept { return iterator(start, cap, head, static_cast<difference_type>(count)); }
+  const_iterator end() const noexcept { return const_iterator(start, cap, head, static_cast<difference_type>(count)); }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  /* capacity 相关操作 */
+  size_type size() const noexcept { return count; }
+  size_type capacity() const noexcept { return cap; }
+  size_type max_size() const noexcept { return static_cast<size_type>(-1) / sizeof(T); }
+  bool empty() const noexcept { return count == 0; }
+  bool full() const noexcept { return count == cap; }
+  circular_buffer_overflow overflow_policy() const noexcept { return policy; }
+  void set_overflow_policy(circular_buffer_overflow p) noexcept { policy = p; }
+
+  /* access 相关操作 */
+  reference operator[](size_type n) { return start[physical(n)]; }
+  const_reference operator[](size_type n) const { return start[physical(n)]; }
+  reference front() { return start[head]; }
+  const_reference front() const { return start[head]; }
+  reference back() { return start[physical(count - 1)]; }
+  const_reference back() const { return start[physical(count - 1)]; }
+
+  /* 连续区段视图
+   * 元素在存储空间中至多分为两段：array_one 为从队头开始的一段，array_two 为绕回存储空间头部的一段（可能为空）
+   * 两段均是连续内存，可以直接交给向量化的处理函数 */
+  array_range array_one() {
+	size_type len = std::min(count, cap - head);
+	return array_range(start + head, len);
+  }
+  const_array_range array_one() const {
+	size_type len = std::min(count, cap - head);
+	return const_array_range(start + head, len);
+  }
+  array_range array_two() {
+	size_type len = count - std::min(count, cap - head);
+	return array_range(start, len);
+  }
+  const_array_range array_two() const {
+	size_type len = count - std::min(count, cap - head);
+	return const_array_range(start, len);
+  }
+  pointer linearize();
+
+  /* container 相关操作
+   * push 系列返回元素是否被写入：overwrite 策略下总是成功，reject 策略下缓冲区已满时返回 false */
+  template<typename ...Args>
+  bool emplace_back(Args &&...args);
+  template<typename ...Args>
+  bool emplace_front(Args &&...args);
+  bool push_back(const value_type &value) { return emplace_back(value); }
+  bool push_back(value_type &&value) { return emplace_back(std::move(value)); }
+  bool push_front(const value_type &value) { return emplace_front(value); }
+  bool push_front(value_type &&value) { return emplace_front(std::move(value)); }
+  void pop_back() {
+	destroy(start + physical(count - 1));
+	--count;
+  }
+  void pop_front() {
+	destroy(start + head);
+	increment(head);
+	--count;
+  }
+  void clear();
+  void swap(circular_buffer &rhs) noexcept {
+	std::swap(start, rhs.start);
+	std::swap(cap, rhs.cap);
+	std::swap(head, rhs.head);
+	std::swap(count, rhs.count);
+	std::swap(policy, rhs.policy);
+  }
+
+  /* 比较操作符的重载 */
+  bool operator==(const circular_buffer &rhs) const {
+	return size() == rhs.size() && std::equal(begin(), end(), rhs.begin());
+  }
+  bool operator!=(const circular_buffer &rhs) const { return !(*this == rhs); }
+}; // circular_buffer end
+
+template<typename T, typename Allocator>
+template<typename InputIterator>
+void circular_buffer<T, Allocator>::copy_init(InputIterator first, InputIterator last) {
+  try {
+	for (; first != last; ++first)
+	  push_back(*first);
+  } catch (...) {
+	clear();
+	data_allocator::deallocate(start, cap);
+	throw;
+  }
+}
+
+template<typename T, typename Allocator>
+template<typename ...Args>
+bool circular_buffer<T, Allocator>::emplace_back(Args &&...args) {
+  if (cap == 0) return false;
+  if (count == cap) {
+	if (policy == circular_buffer_overflow::reject) return false;
+	// 覆盖最旧的元素，尾端随之前进一格
+	start[head] = value_type(std::forward<Args>(args)...);
+	increment(head);
+	return true;
+  }
+  construct(start + physical(count), std::forward<Args>(args)...);
+  ++count;
+  return true;
+}
+
+template<typename T, typename Allocator>
+template<typename ...Args>
+bool circular_buffer<T, Allocator>::emplace_front(Args &&...args) {
+  if (cap == 0) return false;
+  if (count == cap) {
+	if (policy == circular_buffer_overflow::reject) return false;
+	// 覆盖最新的元素，头端随之后退一格
+	decrement(head);
+	start[head] = value_type(std::forward<Args>(args)...);
+	return true;
+  }
+  size_type new_head = head;
+  decrement(new_head);
+  construct(start + new_head, std::forward<Args>(args)...);
+  head = new_head;
+  ++count;
+  return true;
+}
+
+/* 将元素旋转到存储空间头部，使全部元素连续，返回首元素指针 */
+template<typename T, typename Allocator>
+typename circular_buffer<T, Allocator>::pointer circular_buffer<T, Allocator>::linearize() {
+  if (head == 0) return start;
+  if (count == cap) {
+	std::rotate(start, start + head, start + cap);
+  } else {
+	// 空闲槽位中没有已构造的对象，无法原地旋转，改为搬移到新的存储空间
+	pointer new_start = data_allocator::allocate(cap);
+	pointer new_finish = new_start;
+	try {
+	  array_range one = array_one();
+	  array_range two = array_two();
+	  new_finish = std::uninitialized_move(one.first, one.first + one.second, new_start);
+	  new_finish = std::uninitialized_move(two.first, two.first + two.second, new_finish);
+	} catch (...) {
+	  tinystl::destroy(new_start, new_finish);
+	  data_allocator::deallocate(new_start, cap);
+	  throw;
+	}
+	size_type n = count;
+	clear();
+	data_allocator::deallocate(start, cap);
+	start = new_start;
+	count = n;
+  }
+  head = 0;
+  return start;
+}
+
+template<typename T, typename Allocator>
+void circular_buffer<T, Allocator>::clear() {
+  array_range one = array_one();
+  array_range two = array_two();
+  tinystl::destroy(one.first, one.first + one.second);
+  tinystl::destroy(two.first, two.first + two.second);
+  head = 0;
+  count = 0;
+}
+
+template<typename T, typename Allocator>
+inline void swap(circular_buffer<T, Allocator> &lhs, circular_buffer<T, Allocator> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+} // namespace tinystl
+
+#endif //TINYSTL__CIRCULAR_BUFFER_H_
@@ -0,0 +1,167 @@
+//
+// Created by polarnight on 26-10-19, 下午6:20.
+//
+
+#ifndef TINYSTL__CONCURRENT_PRIORITY_QUEUE_H_
+#define TINYSTL__CONCURRENT_PRIORITY_QUEUE_H_
+
+/* <concurrent_priority_queue.h> 实现了 concurrent_priority_queue，一个松弛（relaxed）的并发优先队列（MultiQueue）
+ * 用一把锁保护单个 priority_queue 时，所有线程都在同一把锁与同一个堆顶上竞争，线程数一多吞吐便不再增长。
+ * MultiQueue 将元素分散到 m = c * P 个各自加锁的堆中（P 为线程数，c 为每个线程对应的堆数，缺省为 2）：
+ *   push：随机挑选一个堆，try_lock 成功则压入，失败则换一个堆重试；
+ *   pop：随机挑选两个堆，同时 try_lock 成功后比较两者的堆顶，取出优先级较高者，失败则换一对重试。
+ * 线程之间几乎只在偶然选中同一个堆时才会冲突，因此吞吐随线程数近似线性增长。
+ *
+ * 代价是 try_pop 不再保证取得全局优先级最高的元素。记被取出元素在当前全体元素中的排名为 rank（最高者为 1），
+ * 对 m 个堆做两选一（power of two choices）时，rank 的期望为 O(m)，且以高概率不超过 O(m log m)
+ * （Alistarh 等，The Power of Choice in Priority Scheduling，PODC 2017），与队列中元素的总数无关。
+ * 调度器等只需要"大致按优先级"处理任务的场景可以接受这一误差；需要严格顺序时仍应使用加锁的 priority_queue。
+ *
+ * 堆顶元素的类型 T 是任意的，无法原子地读取，因此比较两个堆顶前需要持有两把锁，而不是读取缓存的堆顶键值。
+ * 随机尝试多次仍未取得元素时，try_pop 会逐个加锁检查全部的堆，因此只有在每个堆被检查时均为空才返回 false */
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "vector.h"
+#include "heap.h"
+
+namespace tinystl {
+/* 各个堆的存储在不同的线程中配置与归还，因此缺省使用线程安全的一级配置器 */
+template<typename T, typename Compare = std::less<T>, typename Allocator = malloc_alloc>
+class concurrent_priority_queue {
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using reference = T &;
+  using const_reference = const T &;
+
+ private:
+  /* 每个堆独占至少一条缓存行，避免相邻的锁之间 false sharing */
+  struct alignas(cache_line_size) sub_queue {
+	std::mutex mutex;
+	tinystl::vector<T, Allocator> heap;
+	std::atomic<size_type> count; // 与 heap.size() 相同，供不加锁时判断是否为空
+
+	sub_queue() { count.store(0, std::memory_order_relaxed); }
+  };
+
+  static constexpr int pop_attempts = 16;
+
+  sub_queue *queues;
+  size_type queue_num;
+  Compare comp;
+
+  /* 每个线程各自的 xorshift 随机数发生器 */
+  static size_type random_index(size_type n) {
+	static thread_local unsigned seed =
+		static_cast<unsigned>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1u;
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed % n;
+  }
+
+  template<typename ...Args>
+  void push_to(sub_queue &q, Args &&...args) {
+	q.heap.emplace_back(std::forward<Args>(args)...);
+	tinystl::push_heap(q.heap.begin(), q.heap.end(), comp);
+	q.count.store(q.heap.size(), std::memory_order_relaxed);
+  }
+  void pop_from(sub_queue &q, value_type &result) {
+	tinystl::pop_heap(q.heap.begin(), q.heap.end(), comp);
+	result = std::move(q.heap.back());
+	q.heap.pop_back();
+	q.count.store(q.heap.size(), std::memory_order_relaxed);
+  }
+
+ public:
+  /* 共 thread_count * queues_per_thread 个堆，至少为 2 */
+  explicit concurrent_priority_queue(size_type thread_count = std::thread::hardware_concurrency(),
+									 size_type queues_per_thread = 2, const Compare &x = Compare())
+	  : queues(nullptr), queue_num(thread_count * queues_per_thread), comp(x) {
+	if (queue_num < 2) queue_num = 2;
+	queues = new sub_queue[queue_num];
+  }
+  concurrent_priority_queue(const concurrent_priority_queue &) = delete;
+  concurrent_priority_queue &operator=(const concurrent_priority_queue &) = delete;
+  ~concurrent_priority_queue() { delete[] queues; }
+
+  /* capacity 相关操作，size 只是一个近似值 */
+  size_type queue_count() const noexcept { return queue_num; }
+  size_type size_approx() const noexcept {
+	size_type n = 0;
+	for (size_type i = 0; i < queue_num; ++i)
+	  n += queues[i].count.load(std::memory_order_relaxed);
+	return n;
+  }
+
+  /* container 相关操作 */
+  template<typename ...Args>
+  void emplace(Args &&...args);
+  void push(const value_type &value) { emplace(value); }
+  void push(value_type &&value) { emplace(std::move(value)); }
+  /* 取出一个优先级接近最高的元素，队列为空时返回 false */
+  bool try_pop(value_type &result);
+};
+
+template<typename T, typename Compare, typename Allocator>
+template<typename ...Args>
+void concurrent_priority_queue<T, Compare, Allocator>::emplace(Args &&...args) {
+  for (;;) {
+	sub_queue &q = queues[random_index(queue_num)];
+	std::unique_lock<std::mutex> lock(q.mutex, std::try_to_lock);
+	if (lock.owns_lock()) {
+	  push_to(q, std::forward<Args>(args)...);
+	  return;
+	}
+  }
+}
+
+template<typename T, typename Compare, typename Allocator>
+bool concurrent_priority_queue<T, Compare, Allocator>::try_pop(value_type &result) {
+  for (int attempt = 0; attempt < pop_attempts; ++attempt) {
+	size_type i = random_index(queue_num);
+	size_type j = (i + 1 + random_index(queue_num - 1)) % queue_num;
+	sub_queue *a = &queues[i];
+	sub_queue *b = &queues[j];
+	// 不加锁地跳过空堆，两个都为空时换一对
+	if (a->count.load(std::memory_order_relaxed) == 0) {
+	  if (b->count.load(std::memory_order_relaxed) == 0)
+		continue;
+	  std::swap(a, b);
+	}
+	std::unique_lock<std::mutex> lock_a(a->mutex, std::try_to_lock);
+	if (!lock_a.owns_lock())
+	  continue;
+	std::unique_lock<std::mutex> lock_b(b->mutex, std::try_to_lock);
+	if (!lock_b.owns_lock())
+	  continue;
+	sub_queue *best = a;
+	if (a->heap.empty() || (!b->heap.empty() && comp(a->heap.front(), b->heap.front())))
+	  best = b;
+	if (best->heap.empty())
+	  continue;
+	pop_from(*best, result);
+	return true;
+  }
+  // 随机尝试均失败，逐个检查全部的堆
+  for (size_type i = 0; i < queue_num; ++i) {
+	sub_queue &q = queues[i];
+	if (q.count.load(std::memory_order_relaxed) == 0)
+	  continue;
+	std::lock_guard<std::mutex> lock(q.mutex);
+	if (!q.heap.empty()) {
+	  pop_from(q, result);
+	  return true;
+	}
+  }
+  return false;
+}
+
+} // namespace tinystl
+
+#endif //TINYSTL__CONCURRENT_PRIORITY_QUEUE_H_
@@ -0,0 +1,405 @@
+//
+// Created by polarnight on 26-10-19, 上午10:05.
+//
+
+#ifndef TINYSTL__CONCURRENT_QUEUE_H_
+#define TINYSTL__CONCURRENT_QUEUE_H_
+
+/* <concurrent_queue.h> 实现了几种无锁（lock-free）队列，用于线程间传递数据
+ * mpmc_queue：有界的多生产者多消费者环形队列（Dmitry Vyukov 的算法）
+ * mpsc_queue：无界的多生产者单消费者链式队列（同为 Vyukov 的 intrusive 算法）
+ * spsc_queue：有界的单生产者单消费者环形队列，支持批量读写与原地访问
+ * 与 <queue.h> 一样只开放尾端写入、头端读取，但不提供 front()/back()，因为在并发下它们没有意义 */
+
+#include <atomic>
+#include <thread> // for std::this_thread::yield
+#include <type_traits> // for std::aligned_storage
+#include <utility> // for std::pair
+
+#include "memory.h"
+
+namespace tinystl {
+/* 将 n 上调至 2 的幂，使得下标可以用 & mask 代替取模 */
+inline size_t round_up_pow2(size_t n) {
+  size_t result = 1;
+  while (result < n) result <<= 1;
+  return result;
+}
+
+/* mpmc_queue
+ * 每个槽位带有一个序号 sequence：
+ *   sequence == pos       表示槽位空闲，生产者可以写入
+ *   sequence == pos + 1   表示槽位已写入，消费者可以读取
+ * 生产者与消费者只在各自的位置计数器上竞争，两个计数器分别独占一条缓存行，避免 false sharing */
+template<typename T, typename Allocator = Alloc>
+class mpmc_queue {
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using reference = T &;
+  using const_reference = const T &;
+
+ private:
+  struct cell {
+	std::atomic<size_type> sequence;
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+	T *value_ptr() { return reinterpret_cast<T *>(&storage); }
+  };
+  using cell_allocator = alloc<cell, Allocator>;
+
+  cell *buffer;
+  const size_type buffer_mask;
+  alignas(cache_line_size) std::atomic<size_type> enqueue_pos;
+  alignas(cache_line_size) std::atomic<size_type> dequeue_pos;
+
+ public:
+  /* capacity 会被上调至 2 的幂，至少为 2 */
+  explicit mpmc_queue(size_type capacity) : buffer_mask(round_up_pow2(capacity < 2 ? 2 : capacity) - 1) {
+	buffer = cell_allocator::allocate(buffer_mask + 1);
+	for (size_type i = 0; i <= buffer_mask; ++i)
+	  ::new(static_cast<void *>(&buffer[i].sequence)) std::atomic<size_type>(i);
+	enqueue_pos.store(0, std::memory_order_relaxed);
+	dequeue_pos.store(0, std::memory_order_relaxed);
+  }
+  mpmc_queue(const mpmc_queue &) = delete;
+  mpmc_queue &operator=(const mpmc_queue &) = delete;
+  ~mpmc_queue() {
+	// 析构时已不存在并发访问，直接销毁尚未取出的元素
+	size_type pos = dequeue_pos.load(std::memory_order_relaxed);
+	size_type last = enqueue_pos.load(std::memory_order_relaxed);
+	for (; pos != last; ++pos)
+	  destroy(buffer[pos & buffer_mask].value_ptr());
+	cell_allocator::deallocate(buffer, buffer_mask + 1);
+  }
+
+  /* capacity 相关操作，size 只是一个近似值 */
+  size_type capacity() const noexcept { return buffer_mask + 1; }
+  size_type size_approx() const noexcept {
+	size_type tail = enqueue_pos.load(std::memory_order_relaxed);
+	size_type head = dequeue_pos.load(std::memory_order_relaxed);
+	return tail > head ? tail - head : 0;
+  }
+  bool empty_approx() const noexcept { return size_approx() == 0; }
+
+  /* container 相关操作
+   * try_ 系列在队列满 / 空时立即返回 false，push/pop 则自旋等待 */
+  template<typename ...Args>
+  bool try_emplace(Args &&...args);
+  bool try_push(const value_type &value) { return try_emplace(value); }
+  bool try_push(value_type &&value) { return try_emplace(std::move(value)); }
+  bool try_pop(value_type &result);
+
+  void push(const value_type &value) {
+	while (!try_push(value)) std::this_thread::yield();
+  }
+  void push(value_type &&value) {
+	while (!try_push(std::move(value))) std::this_thread::yield();
+  }
+  void pop(value_type &result) {
+	while (!try_pop(result)) std::this_thread::yield();
+  }
+};
+
+template<typename T, typename Allocator>
+template<typename ...Args>
+bool mpmc_queue<T, Allocator>::try_emplace(Args &&...args) {
+  cell *c;
+  size_type pos = enqueue_pos.load(std::memory_order_relaxed);
+  for (;;) {
+	c = &buffer[pos & buffer_mask];
+	size_type seq = c->sequence.load(std::memory_order_acquire);
+	ptrdiff_t dif = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos);
+	if (dif == 0) {
+	  if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+		break;
+	} else if (dif < 0) {
+	  return false; // 队列已满
+	} else {
+	  pos = enqueue_pos.load(std::memory_order_relaxed);
+	}
+  }
+  construct(c->value_ptr(), std::forward<Args>(args)...);
+  c->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+template<typename T, typename Allocator>
+bool mpmc_queue<T, Allocator>::try_pop(value_type &result) {
+  cell *c;
+  size_type pos = dequeue_pos.load(std::memory_order_relaxed);
+  for (;;) {
+	c = &buffer[pos & buffer_mask];
+	size_type seq = c->sequence.load(std::memory_order_acquire);
+	ptrdiff_t dif = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos + 1);
+	if (dif == 0) {
+	  if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+		break;
+	} else if (dif < 0) {
+	  return false; // 队列为空
+	} else {
+	  pos = dequeue_pos.load(std::memory_order_relaxed);
+	}
+  }
+  result = std::move(*c->value_ptr());
+  destroy(c->value_ptr());
+  c->sequence.store(pos + buffer_mask + 1, std::memory_order_release);
+  return true;
+}
+
+/********************************************************************************************************************/
+
+/* mpsc_queue
+ * 以单向链表组织，head 为生产者写入端，tail 为消费者读取端，tail 始终指向一个不含值的哨兵节点
+ * 生产者之间只通过一次 exchange 竞争，消费者完全不需要原子的读改写操作
+ * 节点在多个生产者线程中配置，因此缺省使用线程安全的一级配置器，而非内存池实现的 default_alloc */
+template<typename T, typename Allocator = malloc_alloc>
+class mpsc_queue {
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using reference = T &;
+  using const_reference = const T &;
+
+ private:
+  struct node {
+	std::atomic<node *> next;
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+	T *value_ptr() { return reinterpret_cast<T *>(&storage); }
+  };
+  using node_allocator = alloc<node, Allocator>;
+
+  alignas(cache_line_size) std::atomic<node *> head;
+  alignas(cache_line_size) node *tail;
+
+  static node *get_node() {
+	node *n = node_allocator::allocate();
+	::new(static_cast<void *>(&n->next)) std::atomic<node *>(nullptr);
+	return n;
+  }
+  static void put_node(node *n) { node_allocator::deallocate(n); }
+
+ public:
+  mpsc_queue() {
+	node *stub = get_node();
+	head.store(stub, std::memory_order_relaxed);
+	tail = stub;
+  }
+  mpsc_queue(const mpsc_queue &) = delete;
+  mpsc_queue &operator=(const mpsc_queue &) = delete;
+  ~mpsc_queue() {
+	node *cur = tail->next.load(std::memory_order_relaxed);
+	put_node(tail);
+	while (cur) {
+	  node *next = cur->next.load(std::memory_order_relaxed);
+	  destroy(cur->value_ptr());
+	  put_node(cur);
+	  cur = next;
+	}
+  }
+
+  /* 仅可由消费者线程调用 */
+  bool empty() const { return tail->next.load(std::memory_order_acquire) == nullptr; }
+
+  /* container 相关操作，push/emplace 可由任意线程调用，try_pop 只能由唯一的消费者线程调用 */
+  template<typename ...Args>
+  void emplace(Args &&...args);
+  void push(const value_type &value) { emplace(value); }
+  void push(value_type &&value) { emplace(std::move(value)); }
+  bool try_pop(value_type &result);
+};
+
+template<typename T, typename Allocator>
+template<typename ...Args>
+void mpsc_queue<T, Allocator>::emplace(Args &&...args) {
+  node *n = get_node();
+  try {
+	construct(n->value_ptr(), std::forward<Args>(args)...);
+  } catch (...) {
+	put_node(n);
+	throw;
+  }
+  node *prev = head.exchange(n, std::memory_order_acq_rel);
+  // 在 store 之前消费者看不到 n，这段短暂的不一致期间 try_pop 会返回 false
+  prev->next.store(n, std::memory_order_release);
+}
+
+template<typename T, typename Allocator>
+bool mpsc_queue<T, Allocator>::try_pop(value_type &result) {
+  node *next = tail->next.load(std::memory_order_acquire);
+  if (next == nullptr) return false;
+  result = std::move(*next->value_ptr());
+  destroy(next->value_ptr());
+  put_node(tail);
+  tail = next; // next 成为新的哨兵节点
+  return true;
+}
+
+/********************************************************************************************************************/
+
+/* spsc_queue
+ * 生产者只写 tail，消费者只写 head，两者各占一条缓存行
+ * 双方各自缓存对方的索引（cached_head / cached_tail），只有在缓存显示队列满 / 空时才重新读取对方的原子变量，
+ * 因此在稳定的流水线中，每个元素摊还下来的原子操作远少于一次；push_n/pop_n 更是整批只发布一次索引 */
+template<typename T, typename Allocator = Alloc>
+class spsc_queue {
+ public:
+  using value_type = T;
+  using pointer = T *;
+  using size_type = size_t;
+  using reference = T &;
+  using const_reference = const T &;
+
+ private:
+  using data_allocator = alloc<T, Allocator>;
+
+  pointer buffer;
+  const size_type buffer_mask;
+  // 生产者独占
+  alignas(cache_line_size) std::atomic<size_type> tail;
+  size_type cached_head;
+  // 消费者独占
+  alignas(cache_line_size) std::atomic<size_type> head;
+  size_type cached_tail;
+
+  /* 队列中至多还能写入多少个元素，必要时刷新 cached_head */
+  size_type writable(size_type t, size_type want) {
+	size_type free = capacity() - (t - cached_head);
+	if (free < want) {
+	  cached_head = head.load(std::memory_order_acquire);
+	  free = capacity() - (t - cached_head);
+	}
+	return free;
+  }
+  /* 队列中至多还能读出多少个元素，必要时刷新 cached_tail */
+  size_type readable(size_type h, size_type want) {
+	size_type avail = cached_tail - h;
+	if (avail < want) {
+	  cached_tail = tail.load(std::memory_order_acquire);
+	  avail = cached_tail - h;
+	}
+	return avail;
+  }
+
+ public:
+  /* capacity 会被上调至 2 的幂，至少为 2 */
+  explicit spsc_queue(size_type capacity)
+	  : buffer_mask(round_up_pow2(capacity < 2 ? 2 : capacity) - 1), cached_head(0), cached_tail(0) {
+	buffer = data_allocator::allocate(buffer_mask + 1);
+	tail.store(0, std::memory_order_relaxed);
+	head.store(0, std::memory_order_relaxed);
+  }
+  spsc_queue(const spsc_queue &) = delete;
+  spsc_queue &operator=(const spsc_queue &) = delete;
+  ~spsc_queue() {
+	size_type h = head.load(std::memory_order_relaxed);
+	size_type t = tail.load(std::memory_order_relaxed);
+	for (; h != t; ++h)
+	  destroy(buffer + (h & buffer_mask));
+	data_allocator::deallocate(buffer, buffer_mask + 1);
+  }
+
+  /* capacity 相关操作，size 只是一个近似值 */
+  size_type capacity() const noexcept { return buffer_mask + 1; }
+  size_type size_approx() const noexcept {
+	return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_relaxed);
+  }
+  bool empty_approx() const noexcept { return size_approx() == 0; }
+
+  /* 生产者接口 */
+  template<typename ...Args>
+  bool try_emplace(Args &&...args) {
+	const size_type t = tail.load(std::memory_order_relaxed);
+	if (writable(t, 1) == 0) return false;
+	construct(buffer + (t & buffer_mask), std::forward<Args>(args)...);
+	tail.store(t + 1, std::memory_order_release);
+	return true;
+  }
+  bool try_push(const value_type &value) { return try_emplace(value); }
+  bool try_push(value_type &&value) { return try_emplace(std::move(value)); }
+  template<typename InputIterator>
+  size_type push_n(InputIterator first, size_type n);
+
+  /* 消费者接口 */
+  bool try_pop(value_type &result) {
+	const size_type h = head.load(std::memory_order_relaxed);
+	if (readable(h, 1) == 0) return false;
+	pointer p = buffer + (h & buffer_mask);
+	result = std::move(*p);
+	destroy(p);
+	head.store(h + 1, std::memory_order_release);
+	return true;
+  }
+  template<typename OutputIterator>
+  size_type pop_n(OutputIterator result, size_type n);
+
+  /* 原地访问：front 返回队头元素的指针（队列为空时为 nullptr），
+   * read_view 返回从队头开始、在缓冲区中连续的一段可读元素，处理完毕后以 consume 释放，n 超出可读个数时只释放可读的部分 */
+  pointer front() {
+	const size_type h = head.load(std::memory_order_relaxed);
+	return readable(h, 1) == 0 ? nullptr : buffer + (h & buffer_mask);
+  }
+  std::pair<pointer, size_type> read_view() {
+	const size_type h = head.load(std::memory_order_relaxed);
+	size_type avail = readable(h, 1);
+	size_type offset = h & buffer_mask;
+	size_type len = std::min(avail, capacity() - offset);
+	return std::pair<pointer, size_type>(buffer + offset, len);
+  }
+  void consume(size_type n) {
+	const size_type h = head.load(std::memory_order_relaxed);
+	n = std::min(n, readable(h, n)); // 至多释放已写入的元素
+	for (size_type i = 0; i < n; ++i)
+	  destroy(buffer + ((h + i) & buffer_mask));
+	head.store(h + n, std::memory_order_release);
+  }
+};
+
+/* 批量写入至多 n 个元素，返回实际写入的个数
+ * 可写区域至多分为环形缓冲区尾部与头部两段，逐段构造后只发布一次 tail */
+template<typename T, typename Allocator>
+template<typename InputIterator>
+typename spsc_queue<T, Allocator>::size_type
+spsc_queue<T, Allocator>::push_n(InputIterator first, size_type n) {
+  const size_type t = tail.load(std::memory_order_relaxed);
+  n = std::min(n, writable(t, n));
+  size_type i = 0;
+  try {
+	for (; i < n; ++i, ++first)
+	  construct(buffer + ((t + i) & buffer_mask), *first);
+  } catch (...) {
+	for (size_type j = 0; j < i; ++j)
+	  destroy(buffer + ((t + j) & buffer_mask));
+	throw;
+  }
+  tail.store(t + n, std::memory_order_release);
+  return n;
+}
+
+/* 批量读出至多 n 个元素，返回实际读出的个数 */
+template<typename T, typename Allocator>
+template<typename OutputIterator>
+typename spsc_queue<T, Allocator>::size_type
+spsc_queue<T, Allocator>::pop_n(OutputIterator result, size_type n) {
+  const size_type h = head.load(std::memory_order_relaxed);
+  n = std::min(n, readable(h, n));
+  size_type i = 0;
+  try {
+	for (; i < n; ++i, ++result) {
+	  pointer p = buffer + ((h + i) & buffer_mask);
+	  *result = std::move(*p);
+	  destroy(p);
+	}
+  } catch (...) {
+	// 已读出的元素均已析构，发布 head 以免析构函数再次析构它们
+	head.store(h + i, std::memory_order_release);
+	throw;
+  }
+  head.store(h + n, std::memory_order_release);
+  return n;
+}
+
+} // namespace tinystl
+
+#endif //TINYSTL__CONCURRENT_QUEUE_H_
@@ -5,14 +5,42 @@
 #ifndef TINYSTL__DEQUE_H_
 #define TINYSTL__DEQUE_H_
 
+#include <algorithm>
 #include <initializer_list>
+#include <numeric>
 
 #include "memory.h"
 #include "iterator.h"
 
 namespace tinystl {
-inline size_t deque_buf_size(size_t n, size_t sz) {
-  return n != 0 ? n : (sz < 512 ? static_cast<size_t>(512 / sz) : static_cast<size_t>(1));
+/* 缓冲区大小策略
+ * BufSize 为每个缓冲区容纳的元素个数，为 0 时采用缺省的 512 bytes（大对象则每个缓冲区只放 1 个元素）
+ * deque_buf_elems 根据目标字节数（例如一页或一个大页）推算 BufSize，并保证每个缓冲区至少容纳 deque_min_buf_elems 个元素 */
+constexpr size_t deque_default_buf_bytes = 512;
+constexpr size_t deque_page_buf_bytes = 4096;
+constexpr size_t deque_huge_page_buf_bytes = 2 * 1024 * 1024;
+constexpr size_t deque_min_buf_elems = 8;
+
+constexpr size_t deque_buf_size(size_t n, size_t sz) {
+  return n != 0 ? n : (sz < deque_default_buf_bytes ? static_cast<size_t>(deque_default_buf_bytes / sz)
+													: static_cast<size_t>(1));
+}
+
+constexpr size_t deque_buf_elems(size_t target_bytes, size_t sz) {
+  return target_bytes / sz > deque_min_buf_elems ? target_bytes / sz : deque_min_buf_elems;
+}
+
+/* 空闲缓冲区缓存策略
+ * pop 跨越缓冲区边界时，释放出的缓冲区先留在 deque 中（至多 SpareNodes 个），供之后的 push 直接取用，
+ * 避免队列式的负载在边界附近来回震荡时反复地配置与释放缓冲区
+ * 缺省的 SpareNodes 由缓冲区的字节数推算：缓存总量不超过 deque_spare_bytes，个数介于 1 与 deque_max_spare_nodes 之间，
+ * 因此大页缓冲区只缓存 1 个；SpareNodes 为 0 时不缓存 */
+constexpr size_t deque_spare_bytes = 64 * 1024;
+constexpr size_t deque_max_spare_nodes = 4;
+
+constexpr size_t deque_spare_nodes(size_t buf_size, size_t sz) {
+  size_t n = deque_spare_bytes / (deque_buf_size(buf_size, sz) * sz);
+  return n == 0 ? 1 : (n > deque_max_spare_nodes ? deque_max_spare_nodes : n);
 }
 
 template<typename T, typename Ref, typename Ptr, size_t BufSize>
@@ -108,7 +136,200 @@ struct deque_iterator : public tinystl::iterator<random_access_iterator_tag, T>
   }
 }; // deque_iterator end
 
-template<typename T, typename Allocator = Alloc, size_t BufSize = 0>
+/* 分段（segmented）算法
+ * deque_iterator 的每次 ++ 都要检查是否越过缓冲区边界，编译器难以对逐元素的循环做展开或向量化。
+ * 以下重载把 [first, last) 拆成若干段连续的缓冲区，每一段都交给作用于原生指针的算法处理，
+ * 只在段与段之间切换一次缓冲区 */
+
+/* 依次对 [first, last) 中每一段连续内存 [seg_first, seg_last) 调用 f(seg_first, seg_last)，f 返回 false 时提前结束 */
+template<typename T, typename Ref, typename Ptr, size_t BufSize, typename SegmentFunction>
+inline bool for_each_segment(deque_iterator<T, Ref, Ptr, BufSize> first,
+							 deque_iterator<T, Ref, Ptr, BufSize> last,
+							 SegmentFunction f) {
+  if (first.node == last.node)
+	return f(static_cast<Ptr>(first.cur), static_cast<Ptr>(last.cur));
+  if (!f(static_cast<Ptr>(first.cur), static_cast<Ptr>(first.last)))
+	return false;
+  for (T **node = first.node + 1; node < last.node; ++node)
+	if (!f(static_cast<Ptr>(*node), static_cast<Ptr>(*node + first.buffer_size())))
+	  return false;
+  return f(static_cast<Ptr>(last.first), static_cast<Ptr>(last.cur));
+}
+
+/* 将连续内存 [first, last) 复制到 result 起始处，result 为一般的 iterator 时直接转交 std::copy */
+template<typename InputIterator, typename OutputIterator>
+inline OutputIterator copy_segment(InputIterator first, InputIterator last, OutputIterator result) {
+  return std::copy(first, last, result);
+}
+
+/* result 为 deque_iterator 时，按目的端的缓冲区边界分段复制 */
+template<typename U, typename T, size_t BufSize>
+inline deque_iterator<T, T &, T *, BufSize> copy_segment(U *first, U *last, deque_iterator<T, T &, T *, BufSize> result) {
+  while (first != last) {
+	ptrdiff_t n = std::min<ptrdiff_t>(last - first, result.last - result.cur);
+	std::copy(first, first + n, result.cur);
+	first += n;
+	result.cur += n;
+	if (result.cur == result.last) {
+	  result.set_node(result.node + 1);
+	  result.cur = result.first;
+	}
+  }
+  return result;
+}
+
+/* 将连续内存 [first, last) 由后往前复制到 result 之前，result 为一般的 iterator 时直接转交 std::copy_backward */
+template<typename BidirectionalIterator1, typename BidirectionalIterator2>
+inline BidirectionalIterator2 copy_backward_segment(BidirectionalIterator1 first,
+													BidirectionalIterator1 last,
+													BidirectionalIterator2 result) {
+  return std::copy_backward(first, last, result);
+}
+
+/* result 为 deque_iterator 时，按目的端的缓冲区边界分段复制 */
+template<typename U, typename T, size_t BufSize>
+inline deque_iterator<T, T &, T *, BufSize> copy_backward_segment(U *first,
+																   U *last,
+																   deque_iterator<T, T &, T *, BufSize> result) {
+  while (first != last) {
+	if (result.cur == result.first) {
+	  result.set_node(result.node - 1);
+	  result.cur = result.last;
+	}
+	ptrdiff_t n = std::min<ptrdiff_t>(last - first, result.cur - result.first);
+	std::copy_backward(last - n, last, result.cur);
+	last -= n;
+	result.cur -= n;
+  }
+  return result;
+}
+
+/* copy：来源为 deque_iterator */
+template<typename T, typename Ref, typename Ptr, size_t BufSize, typename OutputIterator>
+inline OutputIterator copy(deque_iterator<T, Ref, Ptr, BufSize> first,
+						   deque_iterator<T, Ref, Ptr, BufSize> last,
+						   OutputIterator result) {
+  for_each_segment(first, last, [&result](Ptr seg_first, Ptr seg_last) {
+	result = copy_segment(seg_first, seg_last, result);
+	return true;
+  });
+  return result;
+}
+
+/* copy：来源为原生指针，目的端为 deque_iterator */
+template<typename U, typename T, size_t BufSize>
+inline deque_iterator<T, T &, T *, BufSize> copy(U *first, U *last, deque_iterator<T, T &, T *, BufSize> result) {
+  return copy_segment(first, last, result);
+}
+
+/* copy_backward：来源为 deque_iterator，由最后一段往前处理 */
+template<typename T, typename Ref, typename Ptr, size_t BufSize, typename BidirectionalIterator>
+inline BidirectionalIterator copy_backward(deque_iterator<T, Ref, Ptr, BufSize> first,
+										   deque_iterator<T, Ref, Ptr, BufSize> last,
+										   BidirectionalIterator result) {
+  while (first.node != last.node) {
+	result = copy_backward_segment(static_cast<Ptr>(last.first), static_cast<Ptr>(last.cur), result);
+	last.set_node(last.node - 1);
+	last.cur = last.last;
+  }
+  return copy_backward_segment(static_cast<Ptr>(first.cur), static_cast<Ptr>(last.cur), result);
+}
+
+/* copy_backward：来源为原生指针，目的端为 deque_iterator */
+template<typename U, typename T, size_t BufSize>
+inline deque_iterator<T, T &, T *, BufSize> copy_backward(U *first,
+														  U *last,
+														  deque_iterator<T, T &, T *, BufSize> result) {
+  return copy_backward_segment(first, last, result);
+}
+
+template<typename T, size_t BufSize>
+inline void fill(deque_iterator<T, T &, T *, BufSize> first, deque_iterator<T, T &, T *, BufSize> last, const T &value) {
+  for_each_segment(first, last, [&value](T *seg_first, T *seg_last) {
+	std::fill(seg_first, seg_last, value);
+	return true;
+  });
+}
+
+template<typename T, typename Ref, typename Ptr, size_t BufSize, typename Function>
+inline Function for_each(deque_iterator<T, Ref, Ptr, BufSize> first, deque_iterator<T, Ref, Ptr, BufSize> last, Function f) {
+  for_each_segment(first, last, [&f](Ptr seg_first, Ptr seg_last) {
+	for (; seg_first != seg_last; ++seg_first)
+	  f(*seg_first);
+	return true;
+  });
+  return f;
+}
+
+/* find 需要知道命中元素所在的缓冲区，故直接逐段遍历 map 节点 */
+template<typename T, typename Ref, typename Ptr, size_t BufSize, typename U>
+deque_iterator<T, Ref, Ptr, BufSize> find(deque_iterator<T, Ref, Ptr, BufSize> first,
+										  deque_iterator<T, Ref, Ptr, BufSize> last,
+										  const U &value) {
+  while (first.node != last.node) {
+	Ptr hit = std::find(static_cast<Ptr>(first.cur), static_cast<Ptr>(first.last), value);
+	if (hit != first.last) {
+	  first.cur = const_cast<T *>(hit);
+	  return first;
+	}
+	first.set_node(first.node + 1);
+	first.cur = first.first;
+  }
+  first.cur = const_cast<T *>(std::find(static_cast<Ptr>(first.cur), static_cast<Ptr>(last.cur), value));
+  return first;
+}
+
+/* equal：第二个序列为一般的 iterator，借助 std::mismatch 同时推进第二个序列 */
+template<typename T, typename Ref, typename Ptr, size_t BufSize, typename InputIterator>
+inline bool equal(deque_iterator<T, Ref, Ptr, BufSize> first1,
+				  deque_iterator<T, Ref, Ptr, BufSize> last1,
+				  InputIterator first2) {
+  return for_each_segment(first1, last1, [&first2](Ptr seg_first, Ptr seg_last) {
+	std::pair<Ptr, InputIterator> p = std::mismatch(seg_first, seg_last, first2);
+	first2 = p.second;
+	return p.first == seg_last;
+  });
+}
+
+/* equal：两个序列均为 deque_iterator，每次比较两者当前缓冲区剩余部分中较短的一段 */
+template<typename T, typename Ref1, typename Ptr1, typename Ref2, typename Ptr2, size_t BufSize>
+inline bool equal(deque_iterator<T, Ref1, Ptr1, BufSize> first1,
+				  deque_iterator<T, Ref1, Ptr1, BufSize> last1,
+				  deque_iterator<T, Ref2, Ptr2, BufSize> first2) {
+  return for_each_segment(first1, last1, [&first2](Ptr1 seg_first, Ptr1 seg_last) {
+	while (seg_first != seg_last) {
+	  ptrdiff_t n = std::min<ptrdiff_t>(seg_last - seg_first, first2.last - first2.cur);
+	  if (!std::equal(seg_first, seg_first + n, static_cast<Ptr2>(first2.cur)))
+		return false;
+	  seg_first += n;
+	  first2 += n;
+	}
+	return true;
+  });
+}
+
+template<typename T, typename Ref, typename Ptr, size_t BufSize, typename U>
+inline U accumulate(deque_iterator<T, Ref, Ptr, BufSize> first, deque_iterator<T, Ref, Ptr, BufSize> last, U init) {
+  for_each_segment(first, last, [&init](Ptr seg_first, Ptr seg_last) {
+	init = std::accumulate(seg_first, seg_last, init);
+	return true;
+  });
+  return init;
+}
+
+template<typename T, typename Ref, typename Ptr, size_t BufSize, typename U, typename BinaryOperation>
+inline U accumulate(deque_iterator<T, Ref, Ptr, BufSize> first,
+					deque_iterator<T, Ref, Ptr, BufSize> last,
+					U init,
+					BinaryOperation op) {
+  for_each_segment(first, last, [&init, &op](Ptr seg_first, Ptr seg_last) {
+	init = std::accumulate(seg_first, seg_last, init, op);
+	return true;
+  });
+  return init;
+}
+
+template<typename T, typename Allocator = Alloc, size_t BufSize = 0, size_t SpareNodes = deque_spare_nodes(BufSize, sizeof(T))>
 class deque {
  public:
   using value_type = T;
@@ -133,24 +354,48 @@ class deque {
   iterator finish;
   map_pointer map;
   size_type map_size;
+  pointer spare[SpareNodes != 0 ? SpareNodes : 1]; // 缓存的空闲缓冲区
+  size_type spare_count = 0;
 
   /* 内部辅助函数 */
-  static size_type buffer_size() { return deque_buf_size(0, sizeof(T)); }
+  static size_type buffer_size() { return deque_buf_size(BufSize, sizeof(T)); }
   static size_type init_map_size() { return static_cast<size_type>(8); }
+  static size_type max_spare_nodes() { return SpareNodes; }
   void create_map_nodes(size_type num_element);
   void destroy_map_nodes();
   template<typename InputIterator>
-  void copy_init(InputIterator first, InputIterator last);
+  void copy_init(InputIterator first, InputIterator last) { copy_init(first, last, iterator_category(first)); }
+  template<typename InputIterator>
+  void copy_init(InputIterator first, InputIterator last, input_iterator_tag);
+  template<typename ForwardIterator>
+  void copy_init(ForwardIterator first, ForwardIterator last, forward_iterator_tag);
   void fill_init(size_type n, const value_type &value);
   void insert_aux(iterator pos, size_type n, const value_type &value);
   iterator reserve_elements_at_front(size_type n);
   iterator reserve_elements_at_back(size_type n);
   void destroy_nodes_at_front(iterator before_start);
   void destroy_nodes_at_back(iterator after_finish);
-  pointer allocate_node() { return data_allocator::allocate(buffer_size()); }
-  void deallocate_node(pointer ptr) { data_allocator::deallocate(ptr); }
+  template<typename SegmentConstructor>
+  void construct_at_back(size_type n, SegmentConstructor construct_segment);
+  template<typename InputIterator>
+  void append_aux(InputIterator first, InputIterator last, input_iterator_tag);
+  template<typename ForwardIterator>
+  void append_aux(ForwardIterator first, ForwardIterator last, forward_iterator_tag);
+  pointer allocate_node() {
+	return spare_count != 0 ? spare[--spare_count] : data_allocator::allocate(buffer_size());
+  }
+  void deallocate_node(pointer ptr) {
+	if (spare_count < max_spare_nodes())
+	  spare[spare_count++] = ptr;
+	else
+	  data_allocator::deallocate(ptr, buffer_size());
+  }
+  void release_spare_nodes() {
+	while (spare_count != 0)
+	  data_allocator::deallocate(spare[--spare_count], buffer_size());
+  }
   void reserve_map_at_front(size_type nodes_to_add = 1) {
-	if (nodes_to_add > map - start.node)
+	if (nodes_to_add > size_type(start.node - map))
 	  reallocate_map(nodes_to_add, true);
   }
   void reserve_map_at_back(size_type nodes_to_add = 1) {
@@ -218,8 +463,14 @@ class deque {
 
   /* container 相关操作 */
   void swap(deque &rhs);
-  void push_back(const value_type &value);
-  void push_front(const value_type &value);
+  template<typename ...Args>
+  void emplace_back(Args &&...args);
+  template<typename ...Args>
+  void emplace_front(Args &&...args);
+  void push_back(const value_type &value) { emplace_back(value); }
+  void push_back(value_type &&value) { emplace_back(std::move(value)); }
+  void push_front(const value_type &value) { emplace_front(value); }
+  void push_front(value_type &&value) { emplace_front(std::move(value)); }
   void pop_back();
   void pop_front();
   iterator insert(iterator pos, const value_type &value);
@@ -229,24 +480,35 @@ class deque {
   void insert(iterator pos, long n, const value_type &value) { insert(pos, size_type(n), value); }
   template<typename InputIterator>
   void insert(iterator pos, InputIterator first, InputIterator last);
+  /* 在尾端批量追加元素：一次预留好全部 map 节点与缓冲区，再逐个缓冲区地构造元素 */
+  template<typename InputIterator>
+  void append(InputIterator first, InputIterator last) { append_aux(first, last, iterator_category(first)); }
+  void append_n(size_type n, const value_type &value);
   void resize(size_type new_size, const value_type &value);
   void resize(size_type new_size) { resize(new_size, T()); }
+  void shrink_to_fit();
   iterator erase(iterator pos);
   iterator erase(iterator first, iterator last);
   void clear();
 
   /* 比较操作符的重载 */
-  bool operator==(const deque<T, Allocator, BufSize> &rhs) {
-	return size() == rhs.size() && std::equal(begin(), end(), rhs.begin());
+  bool operator==(const deque<T, Allocator, BufSize, SpareNodes> &rhs) const {
+	return size() == rhs.size() && tinystl::equal(begin(), end(), rhs.begin());
   }
-  bool operator!=(const deque<T, Allocator, BufSize> &rhs) { return !(*this == rhs); }
-  bool operator<(const deque<T, Allocator, BufSize> &rhs) {
+  bool operator!=(const deque<T, Allocator, BufSize, SpareNodes> &rhs) const { return !(*this == rhs); }
+  bool operator<(const deque<T, Allocator, BufSize, SpareNodes> &rhs) const {
 	return std::lexicographical_compare(begin(), end(), rhs.begin(), rhs.end());
   }
 }; // deque end
 
-template<typename T, typename Allocator, size_t BufSize>
-void deque<T, Allocator, BufSize>::create_map_nodes(size_type num_element) {
+/* 以页（或大页）为目标大小配置缓冲区，并令缓冲区从缓存行边界开始
+ * 例如 page_deque<Record> 对 200 bytes 的 Record 每个缓冲区可容纳 20 个元素，而缺省策略只能容纳 2 个 */
+template<typename T, size_t TargetBytes = deque_page_buf_bytes, typename Allocator = cache_aligned_alloc,
+	size_t SpareNodes = deque_spare_nodes(deque_buf_elems(TargetBytes, sizeof(T)), sizeof(T))>
+using page_deque = deque<T, Allocator, deque_buf_elems(TargetBytes, sizeof(T)), SpareNodes>;
+
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+void deque<T, Allocator, BufSize, SpareNodes>::create_map_nodes(size_type num_element) {
   size_type num_nodes = num_element / buffer_size() + 1;
   map_size = std::max(init_map_size(), num_nodes + 2);
   map = map_allocator::allocate(map_size);
@@ -259,7 +521,7 @@ void deque<T, Allocator, BufSize>::create_map_nodes(size_type num_element) {
 	  *cur = allocate_node();
   } catch (...) {
 	for (map_pointer tmp = nstart; tmp < cur; ++tmp)
-	  deallocate_node(*tmp);
+	  data_allocator::deallocate(*tmp, buffer_size());
 	map_allocator::deallocate(map, map_size);
 	throw;
   }
@@ -270,23 +532,46 @@ void deque<T, Allocator, BufSize>::create_map_nodes(size_type num_element) {
   finish.cur = finish.first + num_element % buffer_size();
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-void deque<T, Allocator, BufSize>::destroy_map_nodes() {
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+void deque<T, Allocator, BufSize, SpareNodes>::destroy_map_nodes() {
   for (map_pointer cur = start.node; cur <= finish.node; ++cur)
-	deallocate_node(*cur);
+	data_allocator::deallocate(*cur, buffer_size());
+  release_spare_nodes();
   map_allocator::deallocate(map, map_size);
 }
 
-template<typename T, typename Allocator, size_t BufSize>
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
 template<typename InputIterator>
-void deque<T, Allocator, BufSize>::copy_init(InputIterator first, InputIterator last) {
+void deque<T, Allocator, BufSize, SpareNodes>::copy_init(InputIterator first, InputIterator last, input_iterator_tag) {
   create_map_nodes(0);
   for (; first != last; ++first)
 	push_back(*first);
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-void deque<T, Allocator, BufSize>::fill_init(size_type n, const value_type &value) {
+/* 可预知长度的序列：先一次配置好全部缓冲区，再逐个缓冲区地构造元素 */
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+template<typename ForwardIterator>
+void deque<T, Allocator, BufSize, SpareNodes>::copy_init(ForwardIterator first, ForwardIterator last, forward_iterator_tag) {
+  create_map_nodes(tinystl::distance(first, last));
+  map_pointer cur = start.node;
+  try {
+	for (; cur < finish.node; ++cur) {
+	  ForwardIterator mid = first;
+	  tinystl::advance(mid, buffer_size());
+	  tinystl::uninitialized_copy(first, mid, *cur);
+	  first = mid;
+	}
+	tinystl::uninitialized_copy(first, last, finish.first);
+  } catch (...) {
+	for (map_pointer mptr = start.node; mptr < cur; ++mptr)
+	  tinystl::destroy(*mptr, *mptr + buffer_size());
+	destroy_map_nodes();
+	throw;
+  }
+}
+
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+void deque<T, Allocator, BufSize, SpareNodes>::fill_init(size_type n, const value_type &value) {
   create_map_nodes(n);
   map_pointer cur;
   try {
@@ -301,8 +586,8 @@ void deque<T, Allocator, BufSize>::fill_init(size_type n, const value_type &valu
   }
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-void deque<T, Allocator, BufSize>::insert_aux(iterator pos, size_type n, const value_type &value) {
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+void deque<T, Allocator, BufSize, SpareNodes>::insert_aux(iterator pos, size_type n, const value_type &value) {
   const difference_type elems_before = pos - start;
   size_type length = size();
   if (elems_before < length / 2) {
@@ -315,13 +600,13 @@ void deque<T, Allocator, BufSize>::insert_aux(iterator pos, size_type n, const v
 		iterator start_n = start + n;
 		uninitialized_copy(start, start_n, new_start);
 		start = new_start;
-		std::copy(start_n, pos, old_start);
-		std::fill(pos - n, pos, value);
+		tinystl::copy(start_n, pos, old_start);
+		tinystl::fill(pos - n, pos, value);
 	  } else {
 		iterator mid = uninitialized_copy(start, pos, new_start);
 		uninitialized_fill(mid, start, value);
 		start = new_start;
-		std::fill(old_start, pos, value);
+		tinystl::fill(old_start, pos, value);
 	  }
 	} catch (...) {
 	  destroy_nodes_at_front(new_start);
@@ -338,13 +623,13 @@ void deque<T, Allocator, BufSize>::insert_aux(iterator pos, size_type n, const v
 		iterator finish_n = finish - n;
 		uninitialized_copy(finish_n, finish, finish);
 		finish = new_finish;
-		std::copy_backward(pos, finish_n, old_finish);
-		std::fill(pos, pos + n, value);
+		tinystl::copy_backward(pos, finish_n, old_finish);
+		tinystl::fill(pos, pos + n, value);
 	  } else {
 		uninitialized_fill(finish, pos + n, value);
 		uninitialized_copy(pos, finish, pos + n);
 		finish = new_finish;
-		std::fill(pos, old_finish, value);
+		tinystl::fill(pos, old_finish, value);
 	  }
 	} catch (...) {
 	  destroy_nodes_at_back(new_finish);
@@ -352,8 +637,8 @@ void deque<T, Allocator, BufSize>::insert_aux(iterator pos, size_type n, const v
   }
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-typename deque<T, Allocator, BufSize>::iterator deque<T, Allocator, BufSize>::reserve_elements_at_front(size_type n) {
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+typename deque<T, Allocator, BufSize, SpareNodes>::iterator deque<T, Allocator, BufSize, SpareNodes>::reserve_elements_at_front(size_type n) {
   size_type remain = start.cur - start.first;
   if (n > remain) {
 	size_type new_elements = n - remain;
@@ -372,9 +657,10 @@ typename deque<T, Allocator, BufSize>::iterator deque<T, Allocator, BufSize>::re
   return start - difference_type(n);
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-typename deque<T, Allocator, BufSize>::iterator deque<T, Allocator, BufSize>::reserve_elements_at_back(size_type n) {
-  size_type remain = finish.last - finish.cur;
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+typename deque<T, Allocator, BufSize, SpareNodes>::iterator deque<T, Allocator, BufSize, SpareNodes>::reserve_elements_at_back(size_type n) {
+  // finish 必须指向已配置的缓冲区，因此最后一个空位不计入，恰好填满时也要配置新的缓冲区
+  size_type remain = finish.last - finish.cur - 1;
   if (n > remain) {
 	size_type new_elements = n - remain;
 	size_type new_nodes = (new_elements - 1) / buffer_size() + 1;
@@ -392,36 +678,83 @@ typename deque<T, Allocator, BufSize>::iterator deque<T, Allocator, BufSize>::re
   return finish + difference_type(n);
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-void deque<T, Allocator, BufSize>::destroy_nodes_at_front(iterator before_start) {
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+void deque<T, Allocator, BufSize, SpareNodes>::destroy_nodes_at_front(iterator before_start) {
   for (map_pointer n = before_start.node; n < start.node; ++n)
 	deallocate_node(*n);
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-void deque<T, Allocator, BufSize>::destroy_nodes_at_back(iterator after_finish) {
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+void deque<T, Allocator, BufSize, SpareNodes>::destroy_nodes_at_back(iterator after_finish) {
   for (map_pointer n = after_finish.node; n > finish.node; --n)
 	deallocate_node(*n);
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-void deque<T, Allocator, BufSize>::reallocate_map(size_type nodes_to_add, bool add_at_front) {
+/* 在尾端预留 n 个元素的空间，再对每个缓冲区中待构造的部分调用 construct_segment(seg_first, seg_last)
+ * 任一段构造失败时，销毁已构造的元素并归还新配置的缓冲区，deque 保持原状 */
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+template<typename SegmentConstructor>
+void deque<T, Allocator, BufSize, SpareNodes>::construct_at_back(size_type n, SegmentConstructor construct_segment) {
+  iterator new_finish = reserve_elements_at_back(n);
+  iterator cur = finish;
+  try {
+	while (cur != new_finish) {
+	  pointer seg_last = cur.node == new_finish.node ? new_finish.cur : cur.last;
+	  construct_segment(cur.cur, seg_last);
+	  cur += seg_last - cur.cur;
+	}
+  } catch (...) {
+	tinystl::destroy(finish, cur);
+	destroy_nodes_at_back(new_finish);
+	throw;
+  }
+  finish = new_finish;
+}
+
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+template<typename InputIterator>
+void deque<T, Allocator, BufSize, SpareNodes>::append_aux(InputIterator first, InputIterator last, input_iterator_tag) {
+  for (; first != last; ++first)
+	push_back(*first);
+}
+
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+template<typename ForwardIterator>
+void deque<T, Allocator, BufSize, SpareNodes>::append_aux(ForwardIterator first, ForwardIterator last, forward_iterator_tag) {
+  construct_at_back(tinystl::distance(first, last), [&first](pointer seg_first, pointer seg_last) {
+	ForwardIterator mid = first;
+	tinystl::advance(mid, seg_last - seg_first);
+	tinystl::uninitialized_copy(first, mid, seg_first);
+	first = mid;
+  });
+}
+
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+void deque<T, Allocator, BufSize, SpareNodes>::append_n(size_type n, const value_type &value) {
+  construct_at_back(n, [&value](pointer seg_first, pointer seg_last) {
+	tinystl::uninitialized_fill(seg_first, seg_last, value);
+  });
+}
+
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+void deque<T, Allocator, BufSize, SpareNodes>::reallocate_map(size_type nodes_to_add, bool add_at_front) {
   size_type old_nodes_num = finish.node - start.node + 1;
   size_type new_nodes_num = old_nodes_num + nodes_to_add;
   map_pointer new_nstart;
+  /* map 的剩余空间足够时只在原地将节点移回中央，避免两端交替增长时反复配置新的 map */
   if (map_size > 2 * new_nodes_num) {
-	new_nstart = map + (map_size - new_nodes_num) +
+	new_nstart = map + (map_size - new_nodes_num) / 2 +
 		(add_at_front ? nodes_to_add : 0);
 	if (new_nstart < start.node)
 	  std::copy(start.node, finish.node + 1, new_nstart);
 	else
 	  std::copy_backward(start.node, finish.node + 1,
-						 new_nstart + new_nodes_num);
+						 new_nstart + old_nodes_num);
   } else {
 	size_type new_map_size =
 		map_size + std::max(map_size, nodes_to_add) + 2;
 	map_pointer new_map = map_allocator::allocate(new_map_size);
-	new_nstart = new_map + (new_map_size - new_nodes_num) +
+	new_nstart = new_map + (new_map_size - new_nodes_num) / 2 +
 		(add_at_front ? nodes_to_add : 0);
 	std::copy(start.node, finish.node + 1, new_nstart);
 	map_allocator::deallocate(map, map_size);
@@ -432,67 +765,73 @@ void deque<T, Allocator, BufSize>::reallocate_map(size_type nodes_to_add, bool a
   finish.set_node(new_nstart + old_nodes_num - 1);
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-deque<T, Allocator, BufSize> &deque<T, Allocator, BufSize>::operator=(const deque<T, Allocator, BufSize> &rhs) {
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+deque<T, Allocator, BufSize, SpareNodes> &deque<T, Allocator, BufSize, SpareNodes>::operator=(const deque<T, Allocator, BufSize, SpareNodes> &rhs) {
   const size_type len = size();
   if (&rhs != this) {
 	if (len >= rhs.size())
-	  erase(std::copy(rhs.begin(), rhs.end(), start), finish);
+	  erase(tinystl::copy(rhs.begin(), rhs.end(), start), finish);
 	else {
 	  const_iterator mid = rhs.begin() + difference_type(len);
-	  std::copy(rhs.begin(), rhs.end(), start);
+	  tinystl::copy(rhs.begin(), mid, start);
 	  insert(finish, mid, rhs.end());
 	}
   }
   return *this;
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-void deque<T, Allocator, BufSize>::swap(deque &rhs) {
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+void deque<T, Allocator, BufSize, SpareNodes>::swap(deque &rhs) {
   std::swap(start, rhs.start);
   std::swap(finish, rhs.finish);
   std::swap(map, rhs.map);
   std::swap(map_size, rhs.map_size);
+  std::swap(spare, rhs.spare);
+  std::swap(spare_count, rhs.spare_count);
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-void deque<T, Allocator, BufSize>::push_back(const value_type &value) {
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+template<typename ...Args>
+void deque<T, Allocator, BufSize, SpareNodes>::emplace_back(Args &&...args) {
   if (finish.cur != finish.last - 1) {
-	construct(finish.cur, value);
+	construct(finish.cur, std::forward<Args>(args)...);
 	++finish.cur;
   } else {
 	reserve_map_at_back();
 	*(finish.node + 1) = allocate_node();
 	try {
-	  construct(finish.cur, value);
+	  construct(finish.cur, std::forward<Args>(args)...);
 	  finish.set_node(finish.node + 1);
 	  finish.cur = finish.first;
 	} catch (...) {
 	  deallocate_node(*(finish.node + 1));
+	  throw;
 	}
   }
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-void deque<T, Allocator, BufSize>::push_front(const value_type &value) {
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+template<typename ...Args>
+void deque<T, Allocator, BufSize, SpareNodes>::emplace_front(Args &&...args) {
   if (start.cur != start.first) {
+	construct(start.cur - 1, std::forward<Args>(args)...);
 	--start.cur;
-	construct(start.cur, value);
   } else {
 	reserve_map_at_front();
 	*(start.node - 1) = allocate_node();
 	try {
-	  start.set_node(start.node - 1);
-	  start.cur = start.last - 1;
-	  construct(start.cur, value);
+	  construct(*(start.node - 1) + (buffer_size() - 1), std::forward<Args>(args)...);
 	} catch (...) {
 	  deallocate_node(*(start.node - 1));
+	  throw;
 	}
+	start.set_node(start.node - 1);
+	start.cur = start.last - 1;
   }
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-void deque<T, Allocator, BufSize>::pop_back() {
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+void deque<T, Allocator, BufSize, SpareNodes>::pop_back() {
   if (finish.cur != finish.first) {
 	--finish.cur;
 	destroy(finish.cur);
@@ -504,8 +843,8 @@ void deque<T, Allocator, BufSize>::pop_back() {
   }
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-void deque<T, Allocator, BufSize>::pop_front() {
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+void deque<T, Allocator, BufSize, SpareNodes>::pop_front() {
   destroy(start.cur);
   if (start.cur != start.last - 1) {
 	++start.cur;
@@ -516,8 +855,8 @@ void deque<T, Allocator, BufSize>::pop_front() {
   }
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-typename deque<T, Allocator, BufSize>::iterator deque<T, Allocator, BufSize>::insert(iterator pos,
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+typename deque<T, Allocator, BufSize, SpareNodes>::iterator deque<T, Allocator, BufSize, SpareNodes>::insert(iterator pos,
 																					 const value_type &value) {
   if (pos.cur == start.cur) {
 	push_front(value);
@@ -535,41 +874,42 @@ typename deque<T, Allocator, BufSize>::iterator deque<T, Allocator, BufSize>::in
 	  iterator front2 = front1 + 1;
 	  pos = start + index;
 	  iterator pos1 = pos + 1;
-	  std::copy(front2, pos1, front1);
+	  tinystl::copy(front2, pos1, front1);
 	} else {
 	  push_back(back());
 	  iterator back1 = finish - 1;
 	  iterator back2 = back1 - 1;
 	  pos = start + index;
-	  std::copy_backward(pos, back2, back1);
+	  tinystl::copy_backward(pos, back2, back1);
 	}
 	*pos = value;
 	return pos;
   }
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-void deque<T, Allocator, BufSize>::insert(iterator pos, size_type n, const value_type &value) {
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+void deque<T, Allocator, BufSize, SpareNodes>::insert(iterator pos, size_type n, const value_type &value) {
   if (pos.cur == start.cur) {
 	iterator new_start = reserve_elements_at_front(n);
 	uninitialized_fill(new_start, start, value);
 	start = new_start;
   } else if (pos.cur == finish.cur) {
-	iterator new_finish = reserve_elements_at_back(n);
-	uninitialized_fill(finish, new_finish, value);
-	finish = new_finish;
+	append_n(n, value);
   } else
 	insert_aux(pos, n, value);
 }
 
-template<typename T, typename Allocator, size_t BufSize>
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
 template<typename InputIterator>
-void deque<T, Allocator, BufSize>::insert(iterator pos, InputIterator first, InputIterator last) {
-  std::copy(first, last, std::inserter(*this, pos));
+void deque<T, Allocator, BufSize, SpareNodes>::insert(iterator pos, InputIterator first, InputIterator last) {
+  if (pos.cur == finish.cur)
+	append(first, last);
+  else
+	std::copy(first, last, std::inserter(*this, pos));
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-void deque<T, Allocator, BufSize>::resize(size_type new_size, const value_type &value) {
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+void deque<T, Allocator, BufSize, SpareNodes>::resize(size_type new_size, const value_type &value) {
   const size_type len = size();
   if (new_size < len)
 	erase(start + new_size, finish);
@@ -577,23 +917,23 @@ void deque<T, Allocator, BufSize>::resize(size_type new_size, const value_type &
 	insert(finish, new_size - len, value);
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-typename deque<T, Allocator, BufSize>::iterator deque<T, Allocator, BufSize>::erase(iterator pos) {
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+typename deque<T, Allocator, BufSize, SpareNodes>::iterator deque<T, Allocator, BufSize, SpareNodes>::erase(iterator pos) {
   iterator next = pos;
   ++next;
   difference_type index = pos - start;
   if (index < (size() / 2)) {
-	std::copy_backward(start, pos, next);
+	tinystl::copy_backward(start, pos, next);
 	pop_front();
   } else {
-	std::copy(next, finish, pos);
-	pop_front();
+	tinystl::copy(next, finish, pos);
+	pop_back();
   }
   return start + index;
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-typename deque<T, Allocator, BufSize>::iterator deque<T, Allocator, BufSize>::erase(iterator first, iterator last) {
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+typename deque<T, Allocator, BufSize, SpareNodes>::iterator deque<T, Allocator, BufSize, SpareNodes>::erase(iterator first, iterator last) {
   if (first == start && last == finish) {
 	clear();
 	return finish;
@@ -601,34 +941,52 @@ typename deque<T, Allocator, BufSize>::iterator deque<T, Allocator, BufSize>::er
 	difference_type n = last - first;
 	difference_type elems_before = first - start;
 	if (elems_before < (size() - n) / 2) {
-	  std::copy_backward(start, first, last);
+	  tinystl::copy_backward(start, first, last);
 	  iterator new_start = start + n;
 	  destroy(start, new_start);
 	  for (map_pointer cur = start.node; cur < new_start.node; ++cur)
-		data_allocator::deallocate(*cur, buffer_size());
+		deallocate_node(*cur);
 	  start = new_start;
 	} else {
-	  std::copy(last, finish, first);
+	  tinystl::copy(last, finish, first);
 	  iterator new_finish = finish - n;
 	  destroy(new_finish, finish);
 	  for (map_pointer cur = new_finish.node + 1; cur <= finish.node; ++cur)
-		data_allocator::deallocate(*cur, buffer_size());
+		deallocate_node(*cur);
 	  finish = new_finish;
 	}
 	return start + elems_before;
   }
 }
 
-template<typename T, typename Allocator, size_t BufSize>
-void deque<T, Allocator, BufSize>::clear() {
+/* 归还缓存的空闲缓冲区，并在 map 明显大于所需时，配置一个刚好容纳现有节点（两端各留一个空位）的 map，将节点置于其中央 */
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+void deque<T, Allocator, BufSize, SpareNodes>::shrink_to_fit() {
+  release_spare_nodes();
+  size_type nodes_num = finish.node - start.node + 1;
+  size_type new_map_size = std::max(init_map_size(), nodes_num + 2);
+  if (new_map_size < map_size) {
+	map_pointer new_map = map_allocator::allocate(new_map_size);
+	map_pointer new_nstart = new_map + (new_map_size - nodes_num) / 2;
+	std::copy(start.node, finish.node + 1, new_nstart);
+	map_allocator::deallocate(map, map_size);
+	map = new_map;
+	map_size = new_map_size;
+	start.set_node(new_nstart);
+	finish.set_node(new_nstart + nodes_num - 1);
+  }
+}
+
+template<typename T, typename Allocator, size_t BufSize, size_t SpareNodes>
+void deque<T, Allocator, BufSize, SpareNodes>::clear() {
   for (map_pointer node = start.node + 1; node < finish.node; ++node) {
 	destroy(*node, *node + buffer_size());
-	data_allocator::deallocate(*node, buffer_size());
+	deallocate_node(*node);
   }
   if (start.node != finish.node) {
 	destroy(start.cur, start.last);
 	destroy(finish.first, finish.cur);
-	data_allocator::deallocate(finish.first, buffer_size());
+	deallocate_node(finish.first);
   } else
 	destroy(start.cur, finish.cur);
   finish = start;
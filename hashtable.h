@@ -28,7 +28,7 @@ struct hashtable_const_iterator;
 
 template<typename Value, typename Key, typename HashFcn, typename ExtractKey, typename EqualKey, typename Allocator>
 struct hashtable_iterator {
-  using hashtable = hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>;
+  using hashtable_type = hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>;
   using iterator = hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>;
   using const_iterator = hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>;
   using node = hashtable_node<Value>;
@@ -41,9 +41,9 @@ struct hashtable_iterator {
   using pointer = Value *;
 
   node *cur;
-  hashtable *hash_table;
+  hashtable_type *hash_table;
 
-  hashtable_iterator(node *n, hashtable *tab) : cur(n), hash_table(tab) {}
+  hashtable_iterator(node *n, hashtable_type *tab) : cur(n), hash_table(tab) {}
   hashtable_iterator() = default;
   reference operator*() const { return cur->val; }
   pointer operator->() const { return &(operator*()); }
@@ -76,7 +76,7 @@ hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::operat
 
 template<typename Value, typename Key, typename HashFcn, typename ExtractKey, typename EqualKey, typename Allocator>
 struct hashtable_const_iterator {
-  using hashtable = hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>;
+  using hashtable_type = hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>;
   using iterator = hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>;
   using const_iterator = hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>;
   using node = hashtable_node<Value>;
@@ -89,9 +89,9 @@ struct hashtable_const_iterator {
   using pointer = const Value *;
 
   const node *cur;
-  const hashtable *hash_table;
+  const hashtable_type *hash_table;
 
-  hashtable_const_iterator(node *n, hashtable *tab) : cur(n), hash_table(tab) {}
+  hashtable_const_iterator(node *n, hashtable_type *tab) : cur(n), hash_table(tab) {}
   hashtable_const_iterator() = default;
   reference operator*() const { return cur->val; }
   pointer operator->() const { return &(operator*()); }
@@ -122,6 +122,66 @@ hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::
   return tmp;
 }
 
+/* 节点句柄（node handle），持有一个已从 hashtable 中摘下的节点，由 extract 返回，可再由 insert 链入同类型的 hashtable
+ * 节点在 hashtable 之间移动时既不重新配置也不复制元素。句柄只能移动，析构时销毁其持有的节点 */
+template<typename Value, typename Node, typename NodeAllocator>
+class hashtable_node_handle {
+  template<typename, typename, typename, typename, typename, typename> friend class hashtable;
+
+ public:
+  using value_type = Value;
+
+  hashtable_node_handle() noexcept : node(nullptr) {}
+  hashtable_node_handle(hashtable_node_handle &&rhs) noexcept : node(rhs.node) { rhs.node = nullptr; }
+  hashtable_node_handle &operator=(hashtable_node_handle &&rhs) noexcept {
+	if (this != &rhs) {
+	  reset();
+	  node = rhs.node;
+	  rhs.node = nullptr;
+	}
+	return *this;
+  }
+  hashtable_node_handle(const hashtable_node_handle &) = delete;
+  hashtable_node_handle &operator=(const hashtable_node_handle &) = delete;
+  ~hashtable_node_handle() { reset(); }
+
+  bool empty() const noexcept { return node == nullptr; }
+  explicit operator bool() const noexcept { return node != nullptr; }
+  value_type &value() const { return node->val; }
+  void swap(hashtable_node_handle &rhs) noexcept { std::swap(node, rhs.node); }
+
+ private:
+  explicit hashtable_node_handle(Node *x) noexcept : node(x) {}
+  Node *release() noexcept {
+	Node *x = node;
+	node = nullptr;
+	return x;
+  }
+  void reset() {
+	if (node) {
+	  destroy(&node->val);
+	  NodeAllocator::deallocate(node);
+	  node = nullptr;
+	}
+  }
+
+  Node *node;
+};
+
+template<typename Value, typename Node, typename NodeAllocator>
+inline void swap(hashtable_node_handle<Value, Node, NodeAllocator> &lhs,
+				 hashtable_node_handle<Value, Node, NodeAllocator> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+/* 以节点句柄 insert 的结果：inserted 为 false 时 position 指向键值相同的已有元素，节点仍由 node 持有 */
+template<typename Iterator, typename NodeHandle>
+struct hashtable_insert_return {
+  Iterator position;
+  bool inserted;
+  NodeHandle node;
+};
+
 static const int tinystl_num_primes = 28;
 static const unsigned long tinystl_prime_list[tinystl_num_primes] = {
 	53ul, 97ul, 193ul, 389ul, 769ul,
@@ -166,6 +226,9 @@ class hashtable {
   using data_allocator = alloc<node, Allocator>;
 
  public:
+  using node_type = hashtable_node_handle<value_type, node, node_allocator>;
+  using insert_return_type = hashtable_insert_return<iterator, node_type>;
+
   vector<node *, Allocator> buckets;
   size_type num_elements;
 
@@ -208,7 +271,7 @@ class hashtable {
 	  if (buckets[n]) return iterator(buckets[n], this);
 	return end();
   }
-  iterator end() noexcept { return static_cast<iterator>(nullptr, this); }
+  iterator end() noexcept { return iterator(nullptr, this); }
   iterator end() const noexcept { return static_cast<iterator>(nullptr, this); }
 
   size_type size() const { return num_elements; }
@@ -284,12 +347,26 @@ class hashtable {
   void resize(size_type n);
   void clear();
 
+  /* 节点句柄相关操作，节点只会被摘下或重新链接，不经过配置器，也不复制元素
+   * extract 摘下 position 所指的节点或第一个键值为 key 的节点，不存在时返回空的句柄
+   * insert_unique/insert_equal 将句柄持有的节点链入，insert_unique 遇到重复的键值时节点仍留在返回值的 node 中
+   * merge_unique 将 source 中键值在 *this 中不存在的节点移入 *this，其余的留在 source 中；merge_equal 移入全部节点 */
+  node_type extract(iterator position);
+  node_type extract(const key_type &key) {
+	iterator it = find(key);
+	return it == end() ? node_type() : extract(it);
+  }
+  insert_return_type insert_unique(node_type &&nh);
+  iterator insert_equal(node_type &&nh);
+  void merge_unique(hashtable &source);
+  void merge_equal(hashtable &source);
+
   reference find_or_insert(const value_type &obj);
   iterator find(const key_type &key) {
 	size_type n = bkt_num_key(key);
 	node *first;
 	for (first = buckets[n]; first && !equals(get_key(first->val), key); first = first->next) {}
-	return static_cast<iterator>(first, this);
+	return iterator(first, this);
   }
   const_iterator find(const key_type &key) const {
 	size_type n = bkt_num_key(key);
@@ -324,11 +401,20 @@ class hashtable {
   // 接受实值和 buckets 个数
   size_type bkt_num(const value_type &obj, size_t n) const { return bkt_num_key(get_key(obj), n); }
 
+  // 返回第 n 个 bucket 中键值为 key 的第一个节点，不存在时返回 nullptr
+  node *find_in_bucket(size_type n, const key_type &key) const {
+	node *cur = buckets[n];
+	while (cur && !equals(get_key(cur->val), key))
+	  cur = cur->next;
+	return cur;
+  }
+  iterator link_equal_noresize(node *tmp);
+
   // 节点配置函数
   node *new_node(const value_type &obj) {
 	node *tmp = node_allocator::allocate(1);
 	try {
-	  data_allocator::construct(obj);
+	  construct(&tmp->val, obj);
 	  tmp->next = nullptr;
 	} catch (...) {
 	  node_allocator::deallocate(tmp);
@@ -338,7 +424,7 @@ class hashtable {
   }
   // 节点释放函数
   void delete_node(node *n) {
-	data_allocator::destroy(&n->val);
+	destroy(&n->val);
 	node_allocator::deallocate(n);
 	n = nullptr;
   }
@@ -360,9 +446,9 @@ inline Value *value_type(const hashtable_iterator<Value, Key, HashFcn, ExtractKe
 }
 
 template<typename Value, typename Key, typename HashFcn, typename ExtractKey, typename EqualKey, typename Allocator>
-inline hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::difference_type *
+inline typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::difference_type *
 distance_type(const hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator> &) {
-  return static_cast<hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::difference_type *>(nullptr);
+  return static_cast<typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::difference_type *>(nullptr);
 }
 
 template<typename Value, typename Key, typename HashFcn, typename ExtractKey, typename EqualKey, typename Allocator>
@@ -378,9 +464,9 @@ value_type(const hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, Equal
 }
 
 template<typename Value, typename Key, typename HashFcn, typename ExtractKey, typename EqualKey, typename Allocator>
-inline hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::difference_type *
+inline typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::difference_type *
 distance_type(const hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator> &) {
-  return static_cast<hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::difference_type *>(nullptr);
+  return static_cast<typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::difference_type *>(nullptr);
 }
 
 // operator== 操作，vector 和 list 
@@ -410,7 +496,7 @@ hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>
   node *first = buckets[n];
 
   for (node *cur = first; cur; cur = cur->next)
-	if (_M_equals(get_key(cur->val), get_key(obj)))
+	if (equals(get_key(cur->val), get_key(obj)))
 	  return std::pair<iterator, bool>(iterator(cur, this), false);  // 说明插入节点已经在 hash table 中，不用插入
 
   node *__tmp = new_node(obj); // 头插法
@@ -422,26 +508,109 @@ hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>
 
 // 在不需要重建 buckets 大小下，插入新节点，键值可以重复
 template<typename Value, typename Key, typename HashFcn, typename ExtractKey, typename EqualKey, typename Allocator>
-typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::iterator
+inline typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::iterator
 hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>
 ::insert_equal_noresize(const value_type &obj) {
-  const size_type n = bkt_num(obj);
+  return link_equal_noresize(new_node(obj));
+}
+
+// 在不需要重建 buckets 大小下，链入已配置的节点，键值相等时插入其后
+template<typename Value, typename Key, typename HashFcn, typename ExtractKey, typename EqualKey, typename Allocator>
+typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::iterator
+hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::link_equal_noresize(node *tmp) {
+  const size_type n = bkt_num(tmp->val);
   node *first = buckets[n];
 
   for (node *cur = first; cur; cur = cur->next)
-	if (_M_equals(get_key(cur->val), get_key(obj))) {
-	  node *__tmp = new_node(obj); // 相等，插入后面
-	  __tmp->next = cur->next;
-	  cur->next = __tmp;
+	if (equals(get_key(cur->val), get_key(tmp->val))) {
+	  tmp->next = cur->next;
+	  cur->next = tmp;
 	  ++num_elements;
-	  return iterator(__tmp, this);
+	  return iterator(tmp, this);
 	}
 
-  node *__tmp = new_node(obj);
-  __tmp->next = first;
-  buckets[n] = __tmp;
+  tmp->next = first;
+  buckets[n] = tmp;
   ++num_elements;
-  return iterator(__tmp, this);
+  return iterator(tmp, this);
+}
+
+// 从所在的 bucket 中摘下节点，交由节点句柄持有
+template<typename Value, typename Key, typename HashFcn, typename ExtractKey, typename EqualKey, typename Allocator>
+typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::node_type
+hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::extract(iterator position) {
+  node *p = position.cur;
+  node **link = &buckets[bkt_num(p->val)];
+  while (*link != p)
+	link = &(*link)->next;
+  *link = p->next;
+  p->next = nullptr;
+  --num_elements;
+  return node_type(p);
+}
+
+template<typename Value, typename Key, typename HashFcn, typename ExtractKey, typename EqualKey, typename Allocator>
+typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::insert_return_type
+hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::insert_unique(node_type &&nh) {
+  if (nh.empty())
+	return insert_return_type{end(), false, node_type()};
+  resize(num_elements + 1);
+  const size_type n = bkt_num(nh.node->val);
+  node *cur = find_in_bucket(n, get_key(nh.node->val));
+  if (cur)
+	return insert_return_type{iterator(cur, this), false, std::move(nh)};
+  node *tmp = nh.release(); // 头插法
+  tmp->next = buckets[n];
+  buckets[n] = tmp;
+  ++num_elements;
+  return insert_return_type{iterator(tmp, this), true, node_type()};
+}
+
+template<typename Value, typename Key, typename HashFcn, typename ExtractKey, typename EqualKey, typename Allocator>
+typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::iterator
+hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::insert_equal(node_type &&nh) {
+  if (nh.empty())
+	return end();
+  resize(num_elements + 1);
+  return link_equal_noresize(nh.release());
+}
+
+// 逐个摘下 source 中的节点并链入 *this，键值已存在的节点留在 source 中
+template<typename Value, typename Key, typename HashFcn, typename ExtractKey, typename EqualKey, typename Allocator>
+void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::merge_unique(hashtable &source) {
+  if (&source == this)
+	return;
+  resize(num_elements + source.num_elements);
+  for (size_type i = 0; i < source.buckets.size(); ++i) {
+	node **link = &source.buckets[i];
+	while (*link) {
+	  node *cur = *link;
+	  const size_type n = bkt_num(cur->val);
+	  if (find_in_bucket(n, get_key(cur->val))) {
+		link = &cur->next;
+		continue;
+	  }
+	  *link = cur->next;
+	  --source.num_elements;
+	  cur->next = buckets[n];
+	  buckets[n] = cur;
+	  ++num_elements;
+	}
+  }
+}
+
+template<typename Value, typename Key, typename HashFcn, typename ExtractKey, typename EqualKey, typename Allocator>
+void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::merge_equal(hashtable &source) {
+  if (&source == this)
+	return;
+  resize(num_elements + source.num_elements);
+  for (size_type i = 0; i < source.buckets.size(); ++i) {
+	while (node *cur = source.buckets[i]) {
+	  source.buckets[i] = cur->next;
+	  link_equal_noresize(cur);
+	}
+  }
+  source.num_elements = 0;
 }
 
 // 先查找要插入节点是否在hash table 中，有返回，没有插入新节点
@@ -454,7 +623,7 @@ hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::find_or_insert(
   node *first = buckets[n];
 
   for (node *cur = first; cur; cur = cur->next)
-	if (_M_equals(get_key(cur->val), get_key(obj)))return cur->val;
+	if (equals(get_key(cur->val), get_key(obj)))return cur->val;
 
   node *__tmp = new_node(obj);
   __tmp->next = first;
@@ -471,9 +640,9 @@ hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::equal_range(con
   const size_type n = bkt_num_key(key);
 
   for (node *first = buckets[n]; first; first = first->next)
-	if (_M_equals(get_key(first->val), key)) {
+	if (equals(get_key(first->val), key)) {
 	  for (node *cur = first->next; cur; cur = cur->next)
-		if (!_M_equals(get_key(cur->val), key))return _Pii(iterator(first, this), iterator(cur, this));
+		if (!equals(get_key(cur->val), key))return _Pii(iterator(first, this), iterator(cur, this));
 	  for (size_type __m = n + 1; __m < buckets.size(); ++__m)
 		if (buckets[__m])return _Pii(iterator(first, this), iterator(buckets[__m], this));
 	  return _Pii(iterator(first, this), end());
@@ -492,11 +661,11 @@ hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>
   for (const node *first = buckets[n];
 	   first;
 	   first = first->next) {
-	if (_M_equals(get_key(first->val), key)) {
+	if (equals(get_key(first->val), key)) {
 	  for (const node *cur = first->next;
 		   cur;
 		   cur = cur->next)
-		if (!_M_equals(get_key(cur->val), key))
+		if (!equals(get_key(cur->val), key))
 		  return _Pii(const_iterator(first, this),
 					  const_iterator(cur, this));
 	  for (size_type __m = n + 1; __m < buckets.size(); ++__m)
@@ -521,7 +690,7 @@ hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::erase(const key
 	node *cur = first;
 	node *__next = cur->next;
 	while (__next) {
-	  if (_M_equals(get_key(__next->val), key)) {
+	  if (equals(get_key(__next->val), key)) {
 		cur->next = __next->next;
 		delete_node(__next);
 		__next = cur->next;
@@ -532,7 +701,7 @@ hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::erase(const key
 		__next = cur->next;
 	  }
 	}
-	if (_M_equals(get_key(first->val), key)) {
+	if (equals(get_key(first->val), key)) {
 	  buckets[n] = first->next;
 	  delete_node(first);
 	  ++__erased;
@@ -562,7 +731,7 @@ void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Allocator>::resize(siz
   if (__num_elements_hint > __old_n) {
 	const size_type n = next_size(__num_elements_hint); // 找到下一个质数
 	if (n > __old_n) {
-	  vector<node *, Allocator> __tmp(n, (node *)(0), buckets.get_allocator()); // 设置新的 buckets
+	  vector<node *, Allocator> __tmp(n, (node *)(0)); // 设置新的 buckets
 	  try {
 		for (size_type __bucket = 0; __bucket < __old_n; ++__bucket) {
 		  node *first = buckets[__bucket];
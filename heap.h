@@ -5,106 +5,284 @@
 #ifndef TINYSTL__HEAP_H_
 #define TINYSTL__HEAP_H_
 
-/* <heap.h> 定义了一组 max-heap 算法，用以实现 binary max heap，作为 priority queue 的底层机制 */
+/* <heap.h> 定义了一组 max-heap 算法，用以实现 binary max heap，作为 priority queue 的底层机制
+ * 所有算法都提供两个版本：以 operator< 比较的版本，以及接受比较函数 comp 的版本，前者直接转交后者
+ * 上溯（percolate up）与下溯（percolate down）时先将待安置的元素 move 出来，在路径上留下一个空洞（hole），
+ * 沿路径的元素只需 move 进空洞，最后再将待安置的元素 move 到空洞的最终位置，每层只搬移而不复制一个元素 */
+
+#include <cstddef> // for size_t
+#include <utility> // for std::move
 
 #include "iterator.h"
 
 namespace tinystl {
-/* push_heap 接受两个迭代器，表示 heap 底部容器（vector）的首尾，并且新元素已插入到底部容器的尾端 */
-template<typename RandomAccessIterator, typename Distance, typename T>
-void push_heap(RandomAccessIterator first, Distance hole_index, Distance top_index, T value) {
+/* 非比较函数版本所使用的比较函数 */
+struct heap_less {
+  template<typename T1, typename T2>
+  bool operator()(const T1 &lhs, const T2 &rhs) const { return lhs < rhs; }
+};
+
+/* push_heap 的核心：从 hole_index 向上溯至 top_index，为 value 寻找位置
+ * comp(a, b) 为 true 表示 a 的优先级低于 b */
+template<typename RandomAccessIterator, typename Distance, typename T, typename Compare>
+void push_heap(RandomAccessIterator first, Distance hole_index, Distance top_index, T value, Compare comp) {
   Distance parent = (hole_index - 1) / 2;
-  while (hole_index > top_index && *(first + parent) < value) {
-	*(first + hole_index) = *(first + parent);
+  while (hole_index > top_index && comp(*(first + parent), value)) {
+	*(first + hole_index) = std::move(*(first + parent));
 	hole_index = parent; // percolate up
 	parent = (hole_index - 1) / 2;
   }
-  *(first + hole_index) = value;
+  *(first + hole_index) = std::move(value);
 }
 
-template<typename RandomAccessIterator>
-inline void push_heap_aux(RandomAccessIterator first, RandomAccessIterator last) {
+template<typename RandomAccessIterator, typename Distance, typename T>
+inline void push_heap(RandomAccessIterator first, Distance hole_index, Distance top_index, T value) {
+  tinystl::push_heap(first, hole_index, top_index, std::move(value), heap_less());
+}
+
+/* push_heap 接受两个迭代器，表示 heap 底部容器（vector）的首尾，并且新元素已插入到底部容器的尾端 */
+template<typename RandomAccessIterator, typename Compare>
+inline void push_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
   using distance_type = typename iterator_traits<RandomAccessIterator>::difference_type;
   using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
 
-  push_heap(first,
-			static_cast<distance_type>((last - first) - 1),
-			static_cast<distance_type>(0),
-			static_cast<value_type>(*(last - 1)));
+  if (last - first < 2) return;
+  value_type value = std::move(*(last - 1));
+  tinystl::push_heap(first,
+					 static_cast<distance_type>((last - first) - 1),
+					 static_cast<distance_type>(0),
+					 std::move(value),
+					 comp);
+}
+
+template<typename RandomAccessIterator>
+inline void push_heap(RandomAccessIterator first, RandomAccessIterator last) {
+  tinystl::push_heap(first, last, heap_less());
 }
 
-template<typename RandomAccessIterator, typename Distance, typename T>
-void adjust_heap(RandomAccessIterator first, Distance hole_index, Distance len, T value) {
+/* adjust_heap：从 hole_index 下溯至叶节点，每次将较大的子节点 move 进空洞，再从叶节点处为 value 上溯 */
+template<typename RandomAccessIterator, typename Distance, typename T, typename Compare>
+void adjust_heap(RandomAccessIterator first, Distance hole_index, Distance len, T value, Compare comp) {
   Distance top_index = hole_index;
   Distance second_child = 2 * (hole_index + 1);
 
   while (second_child < len) {
-	if (*(first + second_child) < *(first + second_child - 1))
+	if (comp(*(first + second_child), *(first + (second_child - 1))))
 	  second_child--;
-	*(first + hole_index) = *(first + second_child); // percolate down
+	*(first + hole_index) = std::move(*(first + second_child)); // percolate down
 	hole_index = second_child;
 	second_child = 2 * (second_child + 1);
   }
 
   if (second_child == len) {
-	*(first + hole_index) = *(first + second_child); // percolate down
+	*(first + hole_index) = std::move(*(first + (second_child - 1))); // percolate down
 	hole_index = second_child - 1;
   }
 
-  push_heap(first, hole_index, top_index, value);
+  tinystl::push_heap(first, hole_index, top_index, std::move(value), comp);
 }
 
 template<typename RandomAccessIterator, typename Distance, typename T>
-inline void pop_heap_aux(RandomAccessIterator first,
-						 RandomAccessIterator last,
-						 RandomAccessIterator result,
-						 T value,
-						 Distance *) {
-  *result = *first;
-  adjust_heap(first, Distance(0), Distance(last - first), value);
+inline void adjust_heap(RandomAccessIterator first, Distance hole_index, Distance len, T value) {
+  tinystl::adjust_heap(first, hole_index, len, std::move(value), heap_less());
 }
 
-/* push_heap 接受两个迭代器，表示 heap 底部容器（vector）的首尾 */
-template<typename RandomAccessIterator>
-inline void ppo_heap(RandomAccessIterator first, RandomAccessIterator last) {
+/* pop_heap 接受两个迭代器，表示 heap 底部容器（vector）的首尾
+ * 将堆顶移至 last - 1，再以原先 last - 1 处的元素填补堆顶留下的空洞 */
+template<typename RandomAccessIterator, typename Compare>
+inline void pop_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
   using distance_type = typename iterator_traits<RandomAccessIterator>::difference_type;
   using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
 
-  pop_heap_aux(first,
-			   last - 1,
-			   last - 1,
-			   static_cast<value_type>(*(last - 1)),
-			   static_cast<distance_type>(first));
+  if (last - first < 2) return;
+  value_type value = std::move(*(last - 1));
+  *(last - 1) = std::move(*first);
+  tinystl::adjust_heap(first,
+					   static_cast<distance_type>(0),
+					   static_cast<distance_type>((last - first) - 1),
+					   std::move(value),
+					   comp);
+}
+
+template<typename RandomAccessIterator>
+inline void pop_heap(RandomAccessIterator first, RandomAccessIterator last) {
+  tinystl::pop_heap(first, last, heap_less());
 }
 
 /* sort_heap
  * 获取一个递增序列
  * 接受两个迭代器，表示 heap 底部容器（vector）的首尾 */
+template<typename RandomAccessIterator, typename Compare>
+void sort_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+  while (last - first > 1)
+	tinystl::pop_heap(first, last--, comp);
+}
+
 template<typename RandomAccessIterator>
 void sort_heap(RandomAccessIterator first, RandomAccessIterator last) {
-  while (last - first > 1)
-	ppo_heap(first, last--);
+  tinystl::sort_heap(first, last, heap_less());
 }
 
 /* make_heap
  * 将 [first, last) 排列为一个 heap
  * 接受两个迭代器，表示 heap 底部容器（vector）的首尾 */
+template<typename RandomAccessIterator, typename Compare>
+void make_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+  using distance_type = typename iterator_traits<RandomAccessIterator>::difference_type;
+  using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+  if (last - first < 2) return;
+  distance_type len = last - first;
+  distance_type hole_index = (len - 2) / 2;
+
+  while (true) {
+	value_type value = std::move(*(first + hole_index));
+	tinystl::adjust_heap(first, hole_index, len, std::move(value), comp);
+	if (hole_index == 0) return;
+	--hole_index;
+  }
+}
+
 template<typename RandomAccessIterator>
 void make_heap(RandomAccessIterator first, RandomAccessIterator last) {
+  tinystl::make_heap(first, last, heap_less());
+}
+
+/********************************************************************************************************************/
+
+/* d 叉堆（d-ary heap）
+ * 节点 i 的子节点为 D * i + 1 ... D * i + D，父节点为 (i - 1) / D
+ * 与二叉堆相比，树高降为 log_D(n)，每层的 D 个子节点连续存放，D 取 4 或 8 时通常落在同一条缓存行内，
+ * 大型堆上每层只产生一次缓存缺失；代价是下溯时每层需要 D - 1 次比较以选出最大的子节点。
+ * pop 采用自底向上（bottom-up）的策略：空洞先一路沿最大子节点下溯至叶节点，途中不与待安置的元素比较，
+ * 再从叶节点为其上溯。待安置的元素来自堆尾，通常很小，上溯往往一两步即停止，总比较次数明显少于逐层比较 */
+template<size_t D, typename RandomAccessIterator, typename Distance, typename T, typename Compare>
+void d_ary_push_heap(RandomAccessIterator first, Distance hole_index, Distance top_index, T value, Compare comp) {
+  Distance parent = (hole_index - 1) / static_cast<Distance>(D);
+  while (hole_index > top_index && comp(*(first + parent), value)) {
+	*(first + hole_index) = std::move(*(first + parent));
+	hole_index = parent; // percolate up
+	parent = (hole_index - 1) / static_cast<Distance>(D);
+  }
+  *(first + hole_index) = std::move(value);
+}
+
+template<size_t D, typename RandomAccessIterator, typename Distance, typename T, typename Compare>
+void d_ary_adjust_heap(RandomAccessIterator first, Distance hole_index, Distance len, T value, Compare comp) {
+  const Distance d = static_cast<Distance>(D);
+  Distance top_index = hole_index;
+  Distance child = d * hole_index + 1;
+
+  while (child < len) {
+	Distance child_end = len - child > d ? child + d : len;
+	Distance largest = child;
+	for (Distance i = child + 1; i < child_end; ++i)
+	  if (comp(*(first + largest), *(first + i)))
+		largest = i;
+	*(first + hole_index) = std::move(*(first + largest)); // percolate down
+	hole_index = largest;
+	child = d * hole_index + 1;
+  }
+
+  tinystl::d_ary_push_heap<D>(first, hole_index, top_index, std::move(value), comp);
+}
+
+template<size_t D, typename RandomAccessIterator, typename Compare>
+inline void d_ary_push_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+  using distance_type = typename iterator_traits<RandomAccessIterator>::difference_type;
+  using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+  if (last - first < 2) return;
+  value_type value = std::move(*(last - 1));
+  tinystl::d_ary_push_heap<D>(first,
+							  static_cast<distance_type>((last - first) - 1),
+							  static_cast<distance_type>(0),
+							  std::move(value),
+							  comp);
+}
+
+template<size_t D, typename RandomAccessIterator>
+inline void d_ary_push_heap(RandomAccessIterator first, RandomAccessIterator last) {
+  tinystl::d_ary_push_heap<D>(first, last, heap_less());
+}
+
+template<size_t D, typename RandomAccessIterator, typename Compare>
+inline void d_ary_pop_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+  using distance_type = typename iterator_traits<RandomAccessIterator>::difference_type;
+  using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+  if (last - first < 2) return;
+  value_type value = std::move(*(last - 1));
+  *(last - 1) = std::move(*first);
+  tinystl::d_ary_adjust_heap<D>(first,
+								static_cast<distance_type>(0),
+								static_cast<distance_type>((last - first) - 1),
+								std::move(value),
+								comp);
+}
+
+template<size_t D, typename RandomAccessIterator>
+inline void d_ary_pop_heap(RandomAccessIterator first, RandomAccessIterator last) {
+  tinystl::d_ary_pop_heap<D>(first, last, heap_less());
+}
+
+template<size_t D, typename RandomAccessIterator, typename Compare>
+void d_ary_make_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
   using distance_type = typename iterator_traits<RandomAccessIterator>::difference_type;
   using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
 
   if (last - first < 2) return;
   distance_type len = last - first;
-  distance_type hole_index = (len - 2) / 2;
+  distance_type hole_index = (len - 2) / static_cast<distance_type>(D);
 
   while (true) {
-	adjust_heap(first, hole_index, len, static_cast<value_type>(*(first + hole_index)));
+	value_type value = std::move(*(first + hole_index));
+	tinystl::d_ary_adjust_heap<D>(first, hole_index, len, std::move(value), comp);
 	if (hole_index == 0) return;
 	--hole_index;
-  };
+  }
+}
+
+template<size_t D, typename RandomAccessIterator>
+void d_ary_make_heap(RandomAccessIterator first, RandomAccessIterator last) {
+  tinystl::d_ary_make_heap<D>(first, last, heap_less());
 }
 
+/* 堆策略，供 priority_queue 选择底层的堆算法
+ * binary_heap 即上方的二叉堆算法（其 adjust_heap 本身就是自底向上的），d_ary_heap<D> 为 D 叉堆 */
+struct binary_heap {
+  template<typename RandomAccessIterator, typename Compare>
+  static void push_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+	tinystl::push_heap(first, last, comp);
+  }
+  template<typename RandomAccessIterator, typename Compare>
+  static void pop_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+	tinystl::pop_heap(first, last, comp);
+  }
+  template<typename RandomAccessIterator, typename Compare>
+  static void make_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+	tinystl::make_heap(first, last, comp);
+  }
+};
+
+template<size_t D>
+struct d_ary_heap {
+  static_assert(D >= 2, "d_ary_heap requires at least two children per node");
+
+  template<typename RandomAccessIterator, typename Compare>
+  static void push_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+	tinystl::d_ary_push_heap<D>(first, last, comp);
+  }
+  template<typename RandomAccessIterator, typename Compare>
+  static void pop_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+	tinystl::d_ary_pop_heap<D>(first, last, comp);
+  }
+  template<typename RandomAccessIterator, typename Compare>
+  static void make_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+	tinystl::d_ary_make_heap<D>(first, last, comp);
+  }
+};
+
 } // namespace tinystl
 
 #endif //TINYSTL__HEAP_H_
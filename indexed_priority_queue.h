@@ -0,0 +1,196 @@
+//
+// Created by polarnight on 26-10-19, 下午4:20.
+//
+
+#ifndef TINYSTL__INDEXED_PRIORITY_QUEUE_H_
+#define TINYSTL__INDEXED_PRIORITY_QUEUE_H_
+
+/* <indexed_priority_queue.h> 实现了 indexed_priority_queue，一个可寻址（addressable）的优先队列
+ * push 返回一个 handle，此后可通过 handle 在 O(log n) 内修改元素的优先级或将其删除，
+ * 适用于 Dijkstra、Prim 等需要 decrease-key 的算法，不必再压入重复元素并跳过过期的元素
+ *
+ * 元素保存在 slots 中，handle 即其下标，元素被删除后 handle 会被回收并分配给之后 push 的元素。
+ * 堆中只保存 handle，并直接使用 <heap.h> 的 push_heap/adjust_heap/pop_heap 调整：
+ * heap_entry 在被赋值时记录自身在堆中的下标，因此 sift 过程中每一次搬移都会同步更新 handle 到堆位置的映射。
+ * 由于 heap_entry 持有指向所属队列的指针，队列不可复制或移动 */
+
+#include <functional>
+#include <utility>
+
+#include "vector.h"
+#include "heap.h"
+
+namespace tinystl {
+template<typename T, typename Compare = std::less<T>, typename Allocator = Alloc>
+class indexed_priority_queue {
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using reference = T &;
+  using const_reference = const T &;
+  using handle = size_t;
+
+  static constexpr size_type npos = static_cast<size_type>(-1);
+
+ private:
+  struct slot {
+	T value;
+	size_type pos; // 在堆中的下标，为 npos 表示该 handle 空闲
+
+	template<typename ...Args>
+	explicit slot(size_type p, Args &&...args) : value(std::forward<Args>(args)...), pos(p) {}
+  };
+
+  /* 堆中的元素，被赋值时将自身的下标写回 slots */
+  struct heap_entry {
+	handle h;
+	indexed_priority_queue *owner;
+
+	heap_entry(handle hd, indexed_priority_queue *q) : h(hd), owner(q) {}
+	heap_entry(const heap_entry &) = default;
+	heap_entry &operator=(const heap_entry &rhs) {
+	  h = rhs.h;
+	  owner = rhs.owner;
+	  owner->slots[h].pos = static_cast<size_type>(this - owner->heap.begin());
+	  return *this;
+	}
+  };
+
+  /* 以 handle 所指的元素比较 heap_entry */
+  struct entry_compare {
+	const indexed_priority_queue *q;
+	bool operator()(const heap_entry &lhs, const heap_entry &rhs) const {
+	  return q->comp(q->slots[lhs.h].value, q->slots[rhs.h].value);
+	}
+  };
+
+  tinystl::vector<slot, Allocator> slots;
+  tinystl::vector<heap_entry, Allocator> heap;
+  tinystl::vector<handle, Allocator> free_handles;
+  Compare comp;
+
+  entry_compare entry_comp() const { return entry_compare{this}; }
+  void sift_up(difference_type pos);
+  void sift_down(difference_type pos);
+  void sift(difference_type pos);
+  void remove_at(size_type pos);
+
+ public:
+  indexed_priority_queue() = default;
+  explicit indexed_priority_queue(const Compare &x) : comp(x) {}
+  indexed_priority_queue(const indexed_priority_queue &) = delete;
+  indexed_priority_queue &operator=(const indexed_priority_queue &) = delete;
+
+  /* capacity 相关操作 */
+  bool empty() const noexcept { return heap.empty(); }
+  size_type size() const noexcept { return heap.size(); }
+  void reserve(size_type n) {
+	slots.reserve(n);
+	heap.reserve(n);
+  }
+
+  /* access 相关操作 */
+  const_reference top() const { return slots[heap.front().h].value; }
+  handle top_handle() const { return heap.front().h; }
+  const_reference value(handle h) const { return slots[h].value; }
+  bool contains(handle h) const { return h < slots.size() && slots[h].pos != npos; }
+
+  /* container 相关操作 */
+  template<typename ...Args>
+  handle emplace(Args &&...args);
+  handle push(const value_type &value) { return emplace(value); }
+  handle push(value_type &&value) { return emplace(std::move(value)); }
+  void pop() { remove_at(0); }
+  value_type pop_value() {
+	value_type result = std::move(slots[heap.front().h].value);
+	remove_at(0);
+	return result;
+  }
+  /* 删除 handle 所指的元素，handle 随后失效 */
+  void erase(handle h) { remove_at(slots[h].pos); }
+  void clear() {
+	heap.clear();
+	slots.clear();
+	free_handles.clear();
+  }
+
+  /* 修改 handle 所指元素的值
+   * increase_key 要求新值的优先级不低于原值（即 !comp(value, old)），元素只会向堆顶移动；
+   * decrease_key 要求新值的优先级不高于原值，元素只会向堆底移动；
+   * 例如以 std::greater 实现最小堆的 Dijkstra 中，缩短距离对应 increase_key。
+   * 不确定方向时使用 update，它会先与父节点比较以决定上溯或下溯 */
+  void increase_key(handle h, value_type value) {
+	slots[h].value = std::move(value);
+	sift_up(static_cast<difference_type>(slots[h].pos));
+  }
+  void decrease_key(handle h, value_type value) {
+	slots[h].value = std::move(value);
+	sift_down(static_cast<difference_type>(slots[h].pos));
+  }
+  void update(handle h, value_type value) {
+	slots[h].value = std::move(value);
+	sift(static_cast<difference_type>(slots[h].pos));
+  }
+};
+
+template<typename T, typename Compare, typename Allocator>
+constexpr typename indexed_priority_queue<T, Compare, Allocator>::size_type
+	indexed_priority_queue<T, Compare, Allocator>::npos;
+
+template<typename T, typename Compare, typename Allocator>
+void indexed_priority_queue<T, Compare, Allocator>::sift_up(difference_type pos) {
+  heap_entry entry = heap[pos];
+  tinystl::push_heap(heap.begin(), pos, static_cast<difference_type>(0), entry, entry_comp());
+}
+
+template<typename T, typename Compare, typename Allocator>
+void indexed_priority_queue<T, Compare, Allocator>::sift_down(difference_type pos) {
+  heap_entry entry = heap[pos];
+  tinystl::adjust_heap(heap.begin(), pos, static_cast<difference_type>(heap.size()), entry, entry_comp());
+}
+
+template<typename T, typename Compare, typename Allocator>
+void indexed_priority_queue<T, Compare, Allocator>::sift(difference_type pos) {
+  if (pos > 0 && entry_comp()(heap[(pos - 1) / 2], heap[pos]))
+	sift_up(pos);
+  else
+	sift_down(pos);
+}
+
+template<typename T, typename Compare, typename Allocator>
+template<typename ...Args>
+typename indexed_priority_queue<T, Compare, Allocator>::handle
+indexed_priority_queue<T, Compare, Allocator>::emplace(Args &&...args) {
+  handle h;
+  if (free_handles.empty()) {
+	h = slots.size();
+	slots.emplace_back(heap.size(), std::forward<Args>(args)...);
+  } else {
+	h = free_handles.back();
+	slots[h].value = value_type(std::forward<Args>(args)...);
+	free_handles.pop_back();
+	slots[h].pos = heap.size();
+  }
+  heap.emplace_back(h, this);
+  sift_up(static_cast<difference_type>(heap.size() - 1));
+  return h;
+}
+
+/* 以堆尾的元素填补 pos 处的空位，再将其调整到正确的位置 */
+template<typename T, typename Compare, typename Allocator>
+void indexed_priority_queue<T, Compare, Allocator>::remove_at(size_type pos) {
+  handle h = heap[pos].h;
+  size_type last = heap.size() - 1;
+  if (pos != last)
+	heap[pos] = heap[last];
+  heap.pop_back();
+  slots[h].pos = npos;
+  free_handles.push_back(h);
+  if (pos != last)
+	sift(static_cast<difference_type>(pos));
+}
+
+} // namespace tinystl
+
+#endif //TINYSTL__INDEXED_PRIORITY_QUEUE_H_
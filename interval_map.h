@@ -0,0 +1,153 @@
+//
+// Created by polarnight on 26-10-19, 下午7:55.
+//
+
+#ifndef TINYSTL__INTERVAL_MAP_H_
+#define TINYSTL__INTERVAL_MAP_H_
+
+/* <interval_map.h> 实现了 interval_map，一个以半开区间 [lo, hi) 为键值的区间树（interval tree）
+ * 元素按区间的左端点（其次右端点）排序，允许键值重复。以 rb_tree_summary_augment 在每个节点保存
+ * 其子树中区间右端点的最大值（参见 <tree.h>），查询与 [lo, hi) 重叠的区间时：
+ *   子树中右端点的最大值不大于 lo 时，其中没有区间与之重叠，整棵子树跳过；
+ *   左端点不小于 hi 的区间与中序在其后的区间均不与之重叠，遍历就此结束。
+ * 由此查询的复杂度为 O(log n + k)，k 为重叠的区间数。要求 lo < hi，端点类型 Key 以 operator< 比较 */
+
+#include <functional>
+
+#include "tree.h"
+
+namespace tinystl {
+template<typename Key, typename T, typename Allocator = Alloc>
+class interval_map {
+ public:
+  using key_type = std::pair<Key, Key>;
+  using mapped_type = T;
+  using value_type = std::pair<const key_type, T>;
+  using key_compare = std::less<key_type>;
+
+ private:
+  /* 子树中区间右端点的最大值，empty 表示空子树 */
+  struct max_end {
+	Key value;
+	bool empty;
+  };
+  struct max_end_summary {
+	using summary_type = max_end;
+	static max_end identity() { return max_end{Key(), true}; }
+	static max_end make(const value_type &v) { return max_end{v.first.second, false}; }
+	static max_end combine(const max_end &a, const max_end &b) {
+	  if (a.empty) return b;
+	  if (b.empty) return a;
+	  return a.value < b.value ? b : a;
+	}
+  };
+
+  using base_ptr = rb_tree<key_type, value_type, std::_Select1st<value_type>, key_compare, Allocator,
+						   rb_tree_summary_augment<max_end_summary>>;
+  base_ptr tree;
+
+  /* 访问左端点满足 starts_before、右端点大于 q 的全部区间 */
+  template<typename Tree, typename StartsBefore, typename F>
+  static void overlap_aux(Tree &t, const Key &q, StartsBefore starts_before, F &f) {
+	t.search([&q](const max_end &m) { return q < m.value; },
+			 [&starts_before](const value_type &v) { return !starts_before(v.first.first); },
+			 [&q, &f](decltype(t.begin()) it) {
+			   if (q < it->first.second) f(*it);
+			   return true;
+			 });
+  }
+
+ public:
+  using pointer = typename base_ptr::pointer;
+  using const_pointer = typename base_ptr::const_pointer;
+  using reference = typename base_ptr::reference;
+  using const_reference = typename base_ptr::const_reference;
+  // 键值为 const，区间右端点的汇总不受实值影响，因此允许通过迭代器修改实值
+  using iterator = typename base_ptr::iterator;
+  using const_iterator = typename base_ptr::const_iterator;
+  using difference_type = typename base_ptr::difference_type;
+  using size_type = typename base_ptr::size_type;
+
+  interval_map() : tree(key_compare()) {}
+  template<typename InputIterator>
+  interval_map(InputIterator first, InputIterator last) : tree(key_compare()) { tree.insert_equal(first, last); }
+  interval_map(const interval_map &x) : tree(x.tree) {}
+  interval_map &operator=(const interval_map &x) {
+	tree = x.tree;
+	return *this;
+  }
+
+  /* accessor 相关操作 */
+  iterator begin() { return tree.begin(); }
+  const_iterator begin() const { return tree.begin(); }
+  iterator end() { return tree.end(); }
+  const_iterator end() const { return tree.end(); }
+  bool empty() const { return tree.empty(); }
+  size_type size() const { return tree.size(); }
+  size_type max_size() const { return tree.max_size(); }
+  void swap(interval_map &x) { tree.swap(x.tree); }
+
+  /* container 相关操作 */
+  iterator insert(const value_type &x) { return tree.insert_equal(x); }
+  iterator insert(const Key &lo, const Key &hi, const mapped_type &value) {
+	return tree.insert_equal(value_type(key_type(lo, hi), value));
+  }
+  template<typename InputIterator>
+  void insert(InputIterator first, InputIterator last) { tree.insert_equal(first, last); }
+  void erase(iterator position) { tree.erase(position); }
+  size_type erase(const key_type &x) { return tree.erase(x); }
+  void erase(iterator first, iterator last) { tree.erase(first, last); }
+  void clear() { tree.clear(); }
+
+  /* operator 相关操作，以完整的区间作为键值 */
+  iterator find(const key_type &x) { return tree.find(x); }
+  const_iterator find(const key_type &x) const { return tree.find(x); }
+  size_type count(const key_type &x) const { return tree.count(x); }
+
+  /* 区间查询
+   * for_each_overlap(lo, hi, f) 按左端点的顺序对每个与 [lo, hi) 重叠的元素调用 f(value_type &)
+   * for_each_containing(p, f) 对每个包含点 p 的元素调用 f
+   * find_overlap(lo, hi) 返回左端点最小的与 [lo, hi) 重叠的元素，不存在时返回 end() */
+  template<typename F>
+  void for_each_overlap(const Key &lo, const Key &hi, F f) {
+	overlap_aux(tree, lo, [&hi](const Key &start) { return start < hi; }, f);
+  }
+  template<typename F>
+  void for_each_overlap(const Key &lo, const Key &hi, F f) const {
+	overlap_aux(tree, lo, [&hi](const Key &start) { return start < hi; }, f);
+  }
+  template<typename F>
+  void for_each_containing(const Key &p, F f) {
+	overlap_aux(tree, p, [&p](const Key &start) { return !(p < start); }, f);
+  }
+  template<typename F>
+  void for_each_containing(const Key &p, F f) const {
+	overlap_aux(tree, p, [&p](const Key &start) { return !(p < start); }, f);
+  }
+  iterator find_overlap(const Key &lo, const Key &hi) {
+	iterator result = tree.end();
+	tree.search([&lo](const max_end &m) { return lo < m.value; },
+				[&hi](const value_type &v) { return !(v.first.first < hi); },
+				[&lo, &result](iterator it) {
+				  if (!(lo < it->first.second)) return true;
+				  result = it;
+				  return false;
+				});
+	return result;
+  }
+  const_iterator find_overlap(const Key &lo, const Key &hi) const {
+	return const_cast<interval_map *>(this)->find_overlap(lo, hi);
+  }
+
+  friend bool operator==(const interval_map &lhs, const interval_map &rhs) { return lhs.tree == rhs.tree; }
+  friend bool operator!=(const interval_map &lhs, const interval_map &rhs) { return !(lhs.tree == rhs.tree); }
+}; // class interval_map end
+
+template<typename Key, typename T, typename Allocator>
+inline void swap(interval_map<Key, T, Allocator> &lhs, interval_map<Key, T, Allocator> &rhs) {
+  lhs.swap(rhs);
+}
+
+} // namespace tinystl
+
+#endif //TINYSTL__INTERVAL_MAP_H_
@@ -12,6 +12,7 @@
  *  iostream iterator */
 
 #include <cstddef> // for ptrdiff_t
+#include <iterator> // for std iterator tags
 
 #include "type_traits.h"
 
@@ -33,10 +34,24 @@ struct iterator {
   using reference = Reference;
 };
 
+/* 将 std 容器的 iterator 标签映射为 tinystl 的标签，使 distance/advance 等函数也能作用于 std 容器的 iterator */
+template<typename Category>
+struct iterator_category_map { using type = Category; };
+template<>
+struct iterator_category_map<std::input_iterator_tag> { using type = input_iterator_tag; };
+template<>
+struct iterator_category_map<std::output_iterator_tag> { using type = output_iterator_tag; };
+template<>
+struct iterator_category_map<std::forward_iterator_tag> { using type = forward_iterator_tag; };
+template<>
+struct iterator_category_map<std::bidirectional_iterator_tag> { using type = bidirectional_iterator_tag; };
+template<>
+struct iterator_category_map<std::random_access_iterator_tag> { using type = random_access_iterator_tag; };
+
 /* traits */
 template<typename Iterator>
 struct iterator_traits {
-  using iterator_category = typename Iterator::iterator_category;
+  using iterator_category = typename iterator_category_map<typename Iterator::iterator_category>::type;
   using value_type = typename Iterator::value_type;
   using difference_type = typename Iterator::difference_type;
   using pointer = typename Iterator::pointer;
@@ -134,13 +149,13 @@ inline void distance(InputIterator first, InputIterator last, Distance &n) {
 
 /* advance 的 input_iterator_tag 的版本 */
 template<typename InputIterator, typename Distance>
-inline void advance_aux(InputIterator iter, const Distance &n, input_iterator_tag) {
+inline void advance_aux(InputIterator &iter, Distance n, input_iterator_tag) {
   for (; n != 0; --n, ++iter);
 }
 
 /* advance 的 bidirectional_iterator_tag 的版本 */
 template<typename BidirectionalIterator, typename Distance>
-inline void advance_aux(BidirectionalIterator iter,  Distance n, bidirectional_iterator_tag) {
+inline void advance_aux(BidirectionalIterator &iter, Distance n, bidirectional_iterator_tag) {
   if (n >= 0)
 	while (n--) ++iter;
   else
@@ -149,12 +164,12 @@ inline void advance_aux(BidirectionalIterator iter,  Distance n, bidirectional_i
 
 /* advance 的 random_access_iterator_tag 的版本 */
 template<typename RandomAccessIterator, typename Distance>
-inline void advance_aux(RandomAccessIterator iter,  Distance n, random_access_iterator_tag) {
+inline void advance_aux(RandomAccessIterator &iter, Distance n, random_access_iterator_tag) {
   iter += n;
 }
 
 template<typename InputIterator, typename Distance>
-inline void advance(InputIterator iter,  Distance n) {
+inline void advance(InputIterator &iter, Distance n) {
   advance_aux(iter, n, iterator_category(iter));
 }
 
@@ -15,7 +15,8 @@
 
 namespace tinystl {
 /* 缺省情况下采用递增排序 */
-template<typename Key, typename T, typename Compare = std::less<Key>, typename Allocator = Alloc>
+template<typename Key, typename T, typename Compare = std::less<Key>, typename Allocator = Alloc,
+		 typename Augment = rb_tree_no_augment>
 class map {
  public:
   using key_type = Key;
@@ -26,7 +27,7 @@ class map {
 
   /* 定义一个 functor，用来进行元素比较 */
   class value_compare : public std::binary_function<value_type, value_type, bool> {
-	friend class map<Key, T, Compare, Allocator>;
+	friend class map<Key, T, Compare, Allocator, Augment>;
    private:
 	Compare comp;
 	explicit value_compare(Compare c) : comp(c) {}
@@ -36,8 +37,8 @@ class map {
   };
 
  private:
-  using base_ptr = rb_tree<key_type, value_type, std::_Select1st<value_type>, key_compare, Allocator>;
-  base_ptr rb_tree;
+  using base_ptr = rb_tree<key_type, value_type, std::_Select1st<value_type>, key_compare, Allocator, Augment>;
+  base_ptr tree;
 
  public:
   using pointer = typename base_ptr::const_pointer;
@@ -49,113 +50,142 @@ class map {
   using const_iterator = typename base_ptr::const_iterator;
   using difference_type = typename base_ptr::difference_type;
   using size_type = typename base_ptr::size_type;
+  using node_type = typename base_ptr::node_type;
+  using insert_return_type = typename base_ptr::insert_return_type;
 
-  map() : rb_tree(Compare()) {}
-  explicit map(const Compare &comp) : rb_tree(comp) {}
+  map() : tree(Compare()) {}
+  explicit map(const Compare &comp) : tree(comp) {}
   template<typename InputIterator>
-  map(InputIterator first, InputIterator last) :rb_tree(Compare()) { rb_tree.insert_unique(first, last); }
+  map(InputIterator first, InputIterator last) : tree(Compare()) { tree.insert_unique(first, last); }
   template<typename InputIterator>
-  map(InputIterator first, InputIterator last, const Compare &comp) :rb_tree(comp) {
-	rb_tree.insert_unique(first,
+  map(InputIterator first, InputIterator last, const Compare &comp) : tree(comp) {
+	tree.insert_unique(first,
 						  last);
   }
-  explicit map(const map<Key, Compare, Alloc> &x) : rb_tree(x.rb_tree) {}
+  map(const map &x) : tree(x.tree) {}
   map &operator=(const map &x) {
-	rb_tree = x.rb_tree;
+	tree = x.tree;
 	return *this;
   }
 
   /* 以下为 map 所有操作，由于 <tree.h> 中的 RB-tree 实现均已提供，此处只做调用 */
 
   /* accessor 相关操作 */
-  key_compare key_comp() const { return rb_tree.key_comp(); }
-  value_compare value_comp() const { return key_comp(); }
-  iterator begin() noexcept { return rb_tree.begin(); }
-  const_iterator begin() const noexcept { return rb_tree.begin(); }
-  iterator end() noexcept { return rb_tree.end(); }
-  const_iterator end() const noexcept { return rb_tree.end(); }
-  bool empty() const noexcept { return rb_tree.empty(); }
-  size_type size() const noexcept { return rb_tree.size(); }
-  size_type max_size() const noexcept { return rb_tree.max_size(); }
-  void swap(map<Key, Compare, Alloc> &x) noexcept { rb_tree.swap(x.rb_tree); }
+  key_compare key_comp() const { return tree.key_comp(); }
+  value_compare value_comp() const { return value_compare(key_comp()); }
+  iterator begin() noexcept { return tree.begin(); }
+  const_iterator begin() const noexcept { return tree.begin(); }
+  iterator end() noexcept { return tree.end(); }
+  const_iterator end() const noexcept { return tree.end(); }
+  bool empty() const noexcept { return tree.empty(); }
+  size_type size() const noexcept { return tree.size(); }
+  size_type max_size() const noexcept { return tree.max_size(); }
+  void swap(map &x) noexcept { tree.swap(x.tree); }
 
   /* container 相关操作 */
   using pair_iterator_boll = std::pair<iterator, bool>;
 
   pair_iterator_boll insert(const value_type &x) {
-	std::pair<typename base_ptr::iterator, bool> p = rb_tree.insert_unique(x);
+	std::pair<typename base_ptr::iterator, bool> p = tree.insert_unique(x);
 	return pair_iterator_boll(p.first, p.second);
   }
   iterator insert(iterator position, const value_type &x) {
 	using base_iterator = typename base_ptr::iterator;
-	return rb_tree.insert_unique(static_cast<base_iterator &>(position), x);
+	return tree.insert_unique(base_iterator(position), x);
   }
   template<typename InputIterator>
-  void insert(InputIterator first, InputIterator last) { rb_tree.insert_unique(first, last); }
+  void insert(InputIterator first, InputIterator last) { tree.insert_unique(first, last); }
+  /* 追加有序的区间，区间中的键值大于已有的键值时为 O(k + log n)（参见 <tree.h>） */
+  template<typename InputIterator>
+  void append_sorted(InputIterator first, InputIterator last) { tree.append_sorted_unique(first, last); }
   void erase(iterator position) {
 	using base_iterator = typename base_ptr::iterator;
-	rb_tree.erase(static_cast<base_iterator &>(position));
+	tree.erase(base_iterator(position));
   }
-  size_type erase(const key_type &x) { return rb_tree.erase(x); }
+  size_type erase(const key_type &x) { return tree.erase(x); }
   void erase(iterator first, iterator last) {
 	using base_iterator = typename base_ptr::iterator;
-	rb_tree.erase(static_cast<base_iterator &>(first), static_cast<base_iterator &>(last));
+	tree.erase(base_iterator(first), base_iterator(last));
   }
-  void clear() { rb_tree.clear(); }
+  void clear() { tree.clear(); }
+
+  /* 节点句柄相关操作，节点在容器之间移动时不重新配置，也不复制元素（参见 <tree.h>） */
+  node_type extract(iterator position) { return tree.extract(position); }
+  node_type extract(const key_type &x) { return tree.extract(x); }
+  insert_return_type insert(node_type &&nh) { return tree.insert_unique(std::move(nh)); }
+  void merge(map &source) { tree.merge_unique(source.tree); }
+
+  /* 集合操作，语义与 set 的同名操作相同，只以键值比较，键值相同时 set_union 保留 *this 中的元素 */
+  void split(const key_type &k, map &x) { tree.split(k, x.tree); }
+  void join(map &x) { tree.join(x.tree); }
+  template<typename Fork = rb_tree_serial_fork>
+  void set_union(map &x, Fork fork = Fork()) { tree.union_unique(x.tree, fork); }
+  template<typename Fork = rb_tree_serial_fork>
+  void set_intersection(map &x, Fork fork = Fork()) { tree.intersection(x.tree, fork); }
+  template<typename Fork = rb_tree_serial_fork>
+  void set_difference(map &x, Fork fork = Fork()) { tree.difference(x.tree, fork); }
 
   /* operator 相关操作 */
-  iterator find(const key_type &x) { return rb_tree.find(x); }
-  const_iterator find(const key_type &x) const { return rb_tree.find(x); }
-  size_type count(const key_type &x) const { return rb_tree.count(x); }
-  iterator lower_bound(const key_type &x) { return rb_tree.lower_bound(x); }
-  const_iterator lower_bound(const key_type &x) const { return rb_tree.lower_bound(x); }
-  iterator upper_bound(const key_type &x) { return rb_tree.upper_bound(x); }
-  const_iterator upper_bound(const key_type &x) const { return rb_tree.upper_bound(x); }
-  std::pair<iterator, iterator> equal_range(const key_type &x) { return rb_tree.equal_range(x); }
-  std::pair<iterator, iterator> equal_range(const key_type &x) const { return rb_tree.equal_range(x); }
-  friend bool operator==(const map &lhs, const map &rhs) { return lhs.rb_tree == rhs.rb_tree; }
-  friend bool operator<(const map &lhs, const map &rhs) { return lhs.rb_tree < rhs.rb_tree; }
+  iterator find(const key_type &x) { return tree.find(x); }
+  const_iterator find(const key_type &x) const { return tree.find(x); }
+  size_type count(const key_type &x) const { return tree.count(x); }
+  iterator lower_bound(const key_type &x) { return tree.lower_bound(x); }
+  const_iterator lower_bound(const key_type &x) const { return tree.lower_bound(x); }
+  iterator upper_bound(const key_type &x) { return tree.upper_bound(x); }
+  const_iterator upper_bound(const key_type &x) const { return tree.upper_bound(x); }
+  std::pair<iterator, iterator> equal_range(const key_type &x) { return tree.equal_range(x); }
+  std::pair<const_iterator, const_iterator> equal_range(const key_type &x) const { return tree.equal_range(x); }
+
+  /* 顺序统计，要求 Augment 提供子树大小，如 rb_tree_size_augment（参见 <tree.h>），均为 O(log n) */
+  iterator select(size_type n) { return tree.select(n); }
+  const_iterator select(size_type n) const { return tree.select(n); }
+  size_type rank(const key_type &x) const { return tree.rank(x); }
+  size_type index_of(const_iterator position) const { return tree.index_of(position); }
+  difference_type distance(const_iterator first, const_iterator last) const { return tree.distance(first, last); }
+  friend bool operator==(const map &lhs, const map &rhs) { return lhs.tree == rhs.tree; }
+  friend bool operator<(const map &lhs, const map &rhs) { return lhs.tree < rhs.tree; }
 }; // class map end
 
 /* 重载函数 */
-template<typename Key, typename Compare, typename Allocator>
-inline bool operator==(const map<Key, Compare, Allocator> &lhs, const map<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename T, typename Compare, typename Allocator, typename Augment>
+inline bool operator==(const map<Key, T, Compare, Allocator, Augment> &lhs, const map<Key, T, Compare, Allocator, Augment> &rhs) {
   return lhs == rhs;
 }
 
-template<typename Key, typename Compare, typename Allocator>
-inline bool operator<(const map<Key, Compare, Allocator> &lhs, const map<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename T, typename Compare, typename Allocator, typename Augment>
+inline bool operator<(const map<Key, T, Compare, Allocator, Augment> &lhs, const map<Key, T, Compare, Allocator, Augment> &rhs) {
   return lhs < rhs;
 }
 
-template<typename Key, typename Compare, typename Allocator>
-inline bool operator!=(const map<Key, Compare, Allocator> &lhs, const map<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename T, typename Compare, typename Allocator, typename Augment>
+inline bool operator!=(const map<Key, T, Compare, Allocator, Augment> &lhs, const map<Key, T, Compare, Allocator, Augment> &rhs) {
   return !(lhs == rhs);
 }
 
-template<typename Key, typename Compare, typename Allocator>
-inline bool operator>(const map<Key, Compare, Allocator> &lhs, const map<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename T, typename Compare, typename Allocator, typename Augment>
+inline bool operator>(const map<Key, T, Compare, Allocator, Augment> &lhs, const map<Key, T, Compare, Allocator, Augment> &rhs) {
   return rhs < lhs;
 }
 
-template<typename Key, typename Compare, typename Allocator>
-inline bool operator<=(const map<Key, Compare, Allocator> &lhs, const map<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename T, typename Compare, typename Allocator, typename Augment>
+inline bool operator<=(const map<Key, T, Compare, Allocator, Augment> &lhs, const map<Key, T, Compare, Allocator, Augment> &rhs) {
   return !(rhs < lhs);
 }
 
-template<typename Key, typename Compare, typename Allocator>
-inline bool operator>=(const map<Key, Compare, Allocator> &lhs, const map<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename T, typename Compare, typename Allocator, typename Augment>
+inline bool operator>=(const map<Key, T, Compare, Allocator, Augment> &lhs, const map<Key, T, Compare, Allocator, Augment> &rhs) {
   return !(lhs < rhs);
 }
 
-template<typename Key, typename Compare, typename Allocator>
-inline void swap(const map<Key, Compare, Allocator> &lhs, const map<Key, Compare, Allocator> &rhs) noexcept {
+template<typename Key, typename T, typename Compare, typename Allocator, typename Augment>
+inline void swap(map<Key, T, Compare, Allocator, Augment> &lhs, map<Key, T, Compare, Allocator, Augment> &rhs) noexcept {
   lhs.swap(rhs);
 }
 
 /********************************************************************************************************************/
 
-template<typename Key, typename T, typename Compare = std::less<Key>, typename Allocator = Alloc>
+template<typename Key, typename T, typename Compare = std::less<Key>, typename Allocator = Alloc,
+		 typename Augment = rb_tree_no_augment>
 class multimap {
  public:
   using key_type = Key;
@@ -166,7 +196,7 @@ class multimap {
 
   /* 定义一个 functor，用来进行元素比较 */
   class value_compare : public std::binary_function<value_type, value_type, bool> {
-	friend class map<Key, T, Compare, Allocator>;
+	friend class multimap<Key, T, Compare, Allocator, Augment>;
    private:
 	Compare comp;
 	explicit value_compare(Compare c) : comp(c) {}
@@ -176,8 +206,8 @@ class multimap {
   };
 
  private:
-  using base_ptr = rb_tree<key_type, value_type, std::_Select1st<value_type>, key_compare, Allocator>;
-  base_ptr rb_tree;
+  using base_ptr = rb_tree<key_type, value_type, std::_Select1st<value_type>, key_compare, Allocator, Augment>;
+  base_ptr tree;
 
  public:
   using pointer = typename base_ptr::const_pointer;
@@ -189,107 +219,131 @@ class multimap {
   using const_iterator = typename base_ptr::const_iterator;
   using difference_type = typename base_ptr::difference_type;
   using size_type = typename base_ptr::size_type;
+  using node_type = typename base_ptr::node_type;
 
-  multimap() : rb_tree(Compare()) {}
-  explicit multimap(const Compare &comp) : rb_tree(comp) {}
+  multimap() : tree(Compare()) {}
+  explicit multimap(const Compare &comp) : tree(comp) {}
   template<typename InputIterator>
-  multimap(InputIterator first, InputIterator last) :rb_tree(Compare()) { rb_tree.insert_equal(first, last); }
+  multimap(InputIterator first, InputIterator last) : tree(Compare()) { tree.insert_equal(first, last); }
   template<typename InputIterator>
-  multimap(InputIterator first, InputIterator last, const Compare &comp) :rb_tree(comp) {
-	rb_tree.insert_equal(first,
+  multimap(InputIterator first, InputIterator last, const Compare &comp) : tree(comp) {
+	tree.insert_equal(first,
 						  last);
   }
-  explicit multimap(const map<Key, Compare, Alloc> &x) : rb_tree(x.rb_tree) {}
+  multimap(const multimap &x) : tree(x.tree) {}
   multimap &operator=(const multimap &x) {
-	rb_tree = x.rb_tree;
+	tree = x.tree;
 	return *this;
   }
 
   /* 以下为 multimap 所有操作，由于 <tree.h> 中的 RB-tree 实现均已提供，此处只做调用 */
 
   /* accessor 相关操作 */
-  key_compare key_comp() const { return rb_tree.key_comp(); }
-  value_compare value_comp() const { return key_comp(); }
-  iterator begin() noexcept { return rb_tree.begin(); }
-  const_iterator begin() const noexcept { return rb_tree.begin(); }
-  iterator end() noexcept { return rb_tree.end(); }
-  const_iterator end() const noexcept { return rb_tree.end(); }
-  bool empty() const noexcept { return rb_tree.empty(); }
-  size_type size() const noexcept { return rb_tree.size(); }
-  size_type max_size() const noexcept { return rb_tree.max_size(); }
-  void swap(map<Key, Compare, Alloc> &x) noexcept { rb_tree.swap(x.rb_tree); }
+  key_compare key_comp() const { return tree.key_comp(); }
+  value_compare value_comp() const { return value_compare(key_comp()); }
+  iterator begin() noexcept { return tree.begin(); }
+  const_iterator begin() const noexcept { return tree.begin(); }
+  iterator end() noexcept { return tree.end(); }
+  const_iterator end() const noexcept { return tree.end(); }
+  bool empty() const noexcept { return tree.empty(); }
+  size_type size() const noexcept { return tree.size(); }
+  size_type max_size() const noexcept { return tree.max_size(); }
+  void swap(multimap &x) noexcept { tree.swap(x.tree); }
 
   /* container 相关操作 */
   using pair_iterator_boll = std::pair<iterator, bool>;
 
-  pair_iterator_boll insert(const value_type &x) {
-	std::pair<typename base_ptr::iterator, bool> p = rb_tree.insert_equal(x);
-	return pair_iterator_boll(p.first, p.second);
-  }
+  iterator insert(const value_type &x) { return tree.insert_equal(x); }
   iterator insert(iterator position, const value_type &x) {
 	using base_iterator = typename base_ptr::iterator;
-	return rb_tree.insert_equal(static_cast<base_iterator &>(position), x);
+	return tree.insert_equal(base_iterator(position), x);
   }
   template<typename InputIterator>
-  void insert(InputIterator first, InputIterator last) { rb_tree.insert_equal(first, last); }
+  void insert(InputIterator first, InputIterator last) { tree.insert_equal(first, last); }
+  /* 追加有序的区间，区间中的键值大于已有的键值时为 O(k + log n)（参见 <tree.h>） */
+  template<typename InputIterator>
+  void append_sorted(InputIterator first, InputIterator last) { tree.append_sorted_equal(first, last); }
   void erase(iterator position) {
 	using base_iterator = typename base_ptr::iterator;
-	rb_tree.erase(static_cast<base_iterator &>(position));
+	tree.erase(base_iterator(position));
   }
-  size_type erase(const key_type &x) { return rb_tree.erase(x); }
+  size_type erase(const key_type &x) { return tree.erase(x); }
   void erase(iterator first, iterator last) {
 	using base_iterator = typename base_ptr::iterator;
-	rb_tree.erase(static_cast<base_iterator &>(first), static_cast<base_iterator &>(last));
+	tree.erase(base_iterator(first), base_iterator(last));
   }
-  void clear() { rb_tree.clear(); }
+  void clear() { tree.clear(); }
+
+  /* 节点句柄相关操作，节点在容器之间移动时不重新配置，也不复制元素（参见 <tree.h>） */
+  node_type extract(iterator position) { return tree.extract(position); }
+  node_type extract(const key_type &x) { return tree.extract(x); }
+  iterator insert(node_type &&nh) { return tree.insert_equal(std::move(nh)); }
+  void merge(multimap &source) { tree.merge_equal(source.tree); }
+
+  /* 集合操作，语义与 multiset 的同名操作相同 */
+  void split(const key_type &k, multimap &x) { tree.split(k, x.tree); }
+  void join(multimap &x) { tree.join(x.tree); }
+  template<typename Fork = rb_tree_serial_fork>
+  void set_union(multimap &x, Fork fork = Fork()) { tree.union_equal(x.tree, fork); }
+  template<typename Fork = rb_tree_serial_fork>
+  void set_intersection(multimap &x, Fork fork = Fork()) { tree.intersection(x.tree, fork); }
+  template<typename Fork = rb_tree_serial_fork>
+  void set_difference(multimap &x, Fork fork = Fork()) { tree.difference(x.tree, fork); }
 
   /* operator 相关操作 */
-  iterator find(const key_type &x) { return rb_tree.find(x); }
-  const_iterator find(const key_type &x) const { return rb_tree.find(x); }
-  size_type count(const key_type &x) const { return rb_tree.count(x); }
-  iterator lower_bound(const key_type &x) { return rb_tree.lower_bound(x); }
-  const_iterator lower_bound(const key_type &x) const { return rb_tree.lower_bound(x); }
-  iterator upper_bound(const key_type &x) { return rb_tree.upper_bound(x); }
-  const_iterator upper_bound(const key_type &x) const { return rb_tree.upper_bound(x); }
-  std::pair<iterator, iterator> equal_range(const key_type &x) { return rb_tree.equal_range(x); }
-  std::pair<iterator, iterator> equal_range(const key_type &x) const { return rb_tree.equal_range(x); }
-  friend bool operator==(const multimap &lhs, const multimap &rhs) { return lhs.rb_tree == rhs.rb_tree; }
-  friend bool operator<(const multimap &lhs, const multimap &rhs) { return lhs.rb_tree < rhs.rb_tree; }
+  iterator find(const key_type &x) { return tree.find(x); }
+  const_iterator find(const key_type &x) const { return tree.find(x); }
+  size_type count(const key_type &x) const { return tree.count(x); }
+  iterator lower_bound(const key_type &x) { return tree.lower_bound(x); }
+  const_iterator lower_bound(const key_type &x) const { return tree.lower_bound(x); }
+  iterator upper_bound(const key_type &x) { return tree.upper_bound(x); }
+  const_iterator upper_bound(const key_type &x) const { return tree.upper_bound(x); }
+  std::pair<iterator, iterator> equal_range(const key_type &x) { return tree.equal_range(x); }
+  std::pair<const_iterator, const_iterator> equal_range(const key_type &x) const { return tree.equal_range(x); }
+
+  /* 顺序统计，要求 Augment 提供子树大小，如 rb_tree_size_augment（参见 <tree.h>），均为 O(log n) */
+  iterator select(size_type n) { return tree.select(n); }
+  const_iterator select(size_type n) const { return tree.select(n); }
+  size_type rank(const key_type &x) const { return tree.rank(x); }
+  size_type index_of(const_iterator position) const { return tree.index_of(position); }
+  difference_type distance(const_iterator first, const_iterator last) const { return tree.distance(first, last); }
+  friend bool operator==(const multimap &lhs, const multimap &rhs) { return lhs.tree == rhs.tree; }
+  friend bool operator<(const multimap &lhs, const multimap &rhs) { return lhs.tree < rhs.tree; }
 }; // class multimap end
 
 /* 重载函数 */
-template<typename Key, typename Compare, typename Allocator>
-inline bool operator==(const multimap<Key, Compare, Allocator> &lhs, const multimap<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename T, typename Compare, typename Allocator, typename Augment>
+inline bool operator==(const multimap<Key, T, Compare, Allocator, Augment> &lhs, const multimap<Key, T, Compare, Allocator, Augment> &rhs) {
   return lhs == rhs;
 }
 
-template<typename Key, typename Compare, typename Allocator>
-inline bool operator<(const multimap<Key, Compare, Allocator> &lhs, const multimap<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename T, typename Compare, typename Allocator, typename Augment>
+inline bool operator<(const multimap<Key, T, Compare, Allocator, Augment> &lhs, const multimap<Key, T, Compare, Allocator, Augment> &rhs) {
   return lhs < rhs;
 }
 
-template<typename Key, typename Compare, typename Allocator>
-inline bool operator!=(const multimap<Key, Compare, Allocator> &lhs, const multimap<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename T, typename Compare, typename Allocator, typename Augment>
+inline bool operator!=(const multimap<Key, T, Compare, Allocator, Augment> &lhs, const multimap<Key, T, Compare, Allocator, Augment> &rhs) {
   return !(lhs == rhs);
 }
 
-template<typename Key, typename Compare, typename Allocator>
-inline bool operator>(const multimap<Key, Compare, Allocator> &lhs, const multimap<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename T, typename Compare, typename Allocator, typename Augment>
+inline bool operator>(const multimap<Key, T, Compare, Allocator, Augment> &lhs, const multimap<Key, T, Compare, Allocator, Augment> &rhs) {
   return rhs < lhs;
 }
 
-template<typename Key, typename Compare, typename Allocator>
-inline bool operator<=(const multimap<Key, Compare, Allocator> &lhs, const multimap<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename T, typename Compare, typename Allocator, typename Augment>
+inline bool operator<=(const multimap<Key, T, Compare, Allocator, Augment> &lhs, const multimap<Key, T, Compare, Allocator, Augment> &rhs) {
   return !(rhs < lhs);
 }
 
-template<typename Key, typename Compare, typename Allocator>
-inline bool operator>=(const multimap<Key, Compare, Allocator> &lhs, const multimap<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename T, typename Compare, typename Allocator, typename Augment>
+inline bool operator>=(const multimap<Key, T, Compare, Allocator, Augment> &lhs, const multimap<Key, T, Compare, Allocator, Augment> &rhs) {
   return !(lhs < rhs);
 }
 
-template<typename Key, typename Compare, typename Allocator>
-inline void swap(const multimap<Key, Compare, Allocator> &lhs, const multimap<Key, Compare, Allocator> &rhs) noexcept {
+template<typename Key, typename T, typename Compare, typename Allocator, typename Augment>
+inline void swap(multimap<Key, T, Compare, Allocator, Augment> &lhs, multimap<Key, T, Compare, Allocator, Augment> &rhs) noexcept {
   lhs.swap(rhs);
 }
 
@@ -0,0 +1,99 @@
+//
+// Created by polarnight on 26-10-19, 下午5:50.
+//
+
+#ifndef TINYSTL__PARALLEL_HEAP_H_
+#define TINYSTL__PARALLEL_HEAP_H_
+
+/* <parallel_heap.h> 实现了以 thread_pool 并行的 make_heap
+ * 自底向上建堆时，互不为祖先的节点所在的子树彼此独立：
+ * 先选定一层 L，使该层的 2^L 棵子树数量足以分给全部 worker，各子树在各自的任务中建堆，
+ * 再由当前线程处理 L 层以上的 2^L - 1 个节点。下溯只会触及子树内部的节点，因此各任务之间无需同步。
+ * 序列过短或分出的子树过小时直接退化为串行的 make_heap
+ *
+ * parallel_binary_heap 为 priority_queue 的堆策略：push/pop 与 binary_heap 相同，make_heap 并行执行 */
+
+#include "heap.h"
+#include "thread_pool.h"
+
+namespace tinystl {
+/* 每棵子树至少包含的元素个数，过小的子树不值得作为一个任务 */
+constexpr size_t parallel_heap_grain = 1 << 14;
+
+/* 在 [first, first + len) 中，将以 root 为根的子树排列为 heap */
+template<typename RandomAccessIterator, typename Distance, typename Compare>
+void make_subheap(RandomAccessIterator first, Distance root, Distance len, Compare comp) {
+  using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+  const Distance last_parent = (len - 2) / 2;
+  if (root > last_parent) return;
+  // 找到子树中最深一层仍有子节点的层，lo 为该层最左侧的节点，width 为该层的宽度
+  Distance lo = root;
+  Distance width = 1;
+  while (2 * lo + 1 <= last_parent) {
+	lo = 2 * lo + 1;
+	width *= 2;
+  }
+  // 自底向上逐层、每层自右向左下溯
+  while (true) {
+	Distance hi = lo + width - 1 < last_parent ? lo + width - 1 : last_parent;
+	for (Distance i = hi; i >= lo; --i) {
+	  value_type value = std::move(*(first + i));
+	  tinystl::adjust_heap(first, i, len, std::move(value), comp);
+	}
+	if (lo == root) return;
+	lo = (lo - 1) / 2;
+	width /= 2;
+  }
+}
+
+template<typename RandomAccessIterator, typename Compare>
+void parallel_make_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp, thread_pool &pool) {
+  using distance_type = typename iterator_traits<RandomAccessIterator>::difference_type;
+  using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+  const distance_type len = last - first;
+  // 选择层 L：子树数量达到 worker 数的 4 倍，且每棵子树不小于 parallel_heap_grain
+  const distance_type target = static_cast<distance_type>(4 * pool.size());
+  const distance_type grain = static_cast<distance_type>(parallel_heap_grain);
+  distance_type subtrees = 1;
+  while (subtrees < target && len / (2 * subtrees) >= grain)
+	subtrees *= 2;
+  if (subtrees < 2 || pool.size() < 2) {
+	tinystl::make_heap(first, last, comp);
+	return;
+  }
+
+  // L 层的节点为 [subtrees - 1, 2 * subtrees - 1)
+  {
+	task_group group(pool);
+	for (distance_type root = subtrees - 1; root < 2 * subtrees - 1; ++root)
+	  group.run([first, root, len, comp] { tinystl::make_subheap(first, root, len, comp); });
+	group.wait();
+  }
+  for (distance_type i = subtrees - 2; i >= 0; --i) {
+	value_type value = std::move(*(first + i));
+	tinystl::adjust_heap(first, i, len, std::move(value), comp);
+  }
+}
+
+template<typename RandomAccessIterator, typename Compare>
+inline void parallel_make_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+  tinystl::parallel_make_heap(first, last, comp, default_thread_pool());
+}
+
+template<typename RandomAccessIterator>
+inline void parallel_make_heap(RandomAccessIterator first, RandomAccessIterator last) {
+  tinystl::parallel_make_heap(first, last, heap_less(), default_thread_pool());
+}
+
+struct parallel_binary_heap : binary_heap {
+  template<typename RandomAccessIterator, typename Compare>
+  static void make_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp) {
+	tinystl::parallel_make_heap(first, last, comp);
+  }
+};
+
+} // namespace tinystl
+
+#endif //TINYSTL__PARALLEL_HEAP_H_
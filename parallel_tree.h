@@ -0,0 +1,68 @@
+//
+// Created by polarnight on 26-10-19, 下午11:50.
+//
+
+#ifndef TINYSTL__PARALLEL_TREE_H_
+#define TINYSTL__PARALLEL_TREE_H_
+
+/* <parallel_tree.h> 以 thread_pool 并行执行 rb_tree 的 join-based 集合运算（union/intersection/difference）
+ * 集合运算以一棵树的根分割另一棵树后，两侧的递归互不相交：
+ * rb_tree_parallel_fork 在递归的前 depth 层将左分支交给线程池、当前线程执行右分支，更深的层次依次执行。
+ * 被舍弃的节点由调用线程在运算结束后统一归还（参见 <tree.h>），因此并行的部分不会调用配置器。
+ * parallel_tree_fork 按元素总数与线程数选择 depth，元素过少或只有一个线程时不并行 */
+
+#include "tree.h"
+#include "thread_pool.h"
+
+namespace tinystl {
+/* 两棵树的元素总数不小于此值时才并行执行 */
+constexpr size_t parallel_tree_threshold = 1 << 15;
+
+class rb_tree_parallel_fork {
+ public:
+  rb_tree_parallel_fork(thread_pool &pool, int depth) : pool(&pool), depth(depth) {}
+
+  template<typename LeftTask, typename RightTask>
+  void operator()(LeftTask left, RightTask right) const {
+	if (depth > 0) {
+	  task_group group(*pool);
+	  group.run(left);
+	  right();
+	  group.wait();
+	} else {
+	  left();
+	  right();
+	}
+  }
+  rb_tree_parallel_fork child() const { return rb_tree_parallel_fork(*pool, depth - 1); }
+
+ private:
+  thread_pool *pool;
+  int depth;
+};
+
+/* n 为两棵树的元素总数，递归的前 depth 层并行执行，使任务数约为线程数的 4 倍 */
+inline rb_tree_parallel_fork parallel_tree_fork(size_t n, thread_pool &pool = default_thread_pool()) {
+  int depth = 0;
+  if (n >= parallel_tree_threshold && pool.size() > 1)
+	for (size_t m = 1; m < 4 * pool.size(); m <<= 1) ++depth;
+  return rb_tree_parallel_fork(pool, depth);
+}
+
+/* set/multiset/map/multimap 的并行集合运算，语义与各容器的 set_union/set_intersection/set_difference 相同 */
+template<typename Container>
+void parallel_set_union(Container &c, Container &x, thread_pool &pool = default_thread_pool()) {
+  c.set_union(x, parallel_tree_fork(c.size() + x.size(), pool));
+}
+template<typename Container>
+void parallel_set_intersection(Container &c, Container &x, thread_pool &pool = default_thread_pool()) {
+  c.set_intersection(x, parallel_tree_fork(c.size() + x.size(), pool));
+}
+template<typename Container>
+void parallel_set_difference(Container &c, Container &x, thread_pool &pool = default_thread_pool()) {
+  c.set_difference(x, parallel_tree_fork(c.size() + x.size(), pool));
+}
+
+} // namespace tinystl
+
+#endif //TINYSTL__PARALLEL_TREE_H_
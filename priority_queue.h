@@ -6,14 +6,17 @@
 #define TINYSTL__PRIORITY_QUEUE_H_
 
 /* <priority_queue.h> 实现了 priority_queue
- * 此处以 vector 为底部结构并封闭其头端开口，就能轻松实现 */
+ * 此处以 vector 为底部结构并封闭其头端开口，就能轻松实现
+ * 第四个模板参数 HeapPolicy 选择底层的堆算法，缺省为二叉堆，d_ary_priority_queue 则以 D 叉堆实现 */
+
+#include <utility>
 
 #include "vector.h"
 #include "heap.h"
 
 namespace tinystl {
 template<typename T, typename Sequence = tinystl::vector<T>,
-	typename Compare = std::less<typename Sequence::value_type>>
+	typename Compare = std::less<typename Sequence::value_type>, typename HeapPolicy = binary_heap>
 class priority_queue {
  public:
   using value_type = typename Sequence::value_type;
@@ -29,35 +32,77 @@ class priority_queue {
   explicit priority_queue(const Compare &x) : c(), comp(x) {}
   template<typename InputIterator>
   priority_queue(InputIterator first, InputIterator last) : c(first, last) {
-	tinystl::make_heap(c.begin(), c.end(), comp);
+	HeapPolicy::make_heap(c.begin(), c.end(), comp);
   }
   template<typename InputIterator>
   priority_queue(InputIterator first, InputIterator last, const Compare &x) : c(first, last), comp(x) {
-	tinystl::make_heap(c.begin(), c.end(), comp);
+	HeapPolicy::make_heap(c.begin(), c.end(), comp);
   }
 
  public:
   bool empty() const noexcept { return c.empty(); }
   size_type size() const noexcept { return c.size(); }
   const_reference top() const { return c.front(); }
-  void push(const value_type &value) {
+  void push(const value_type &value) { emplace(value); }
+  void push(value_type &&value) { emplace(std::move(value)); }
+  template<typename ...Args>
+  void emplace(Args &&...args) {
+	try {
+	  c.emplace_back(std::forward<Args>(args)...);
+	  HeapPolicy::push_heap(c.begin(), c.end(), comp);
+	} catch (...) {
+	  c.clear();
+	  throw;
+	}
+  }
+  /* 批量插入：先将 [first, last) 全部追加到尾端，再视新增元素的个数 k 决定调整方式
+   * 逐个上溯的代价约为 k * log2(n) 次比较，整体重新建堆约为 2 * n 次，取其较小者 */
+  template<typename InputIterator>
+  void push_range(InputIterator first, InputIterator last) {
+	const size_type old_size = c.size();
 	try {
-	  c.push_back(value);
-	  tinystl::push_heap(c.begin(), c.end(), comp);
+	  for (; first != last; ++first)
+		c.push_back(*first);
+	  const size_type n = c.size();
+	  size_type log_n = 0;
+	  for (size_type m = n; m > 1; m >>= 1) ++log_n;
+	  if ((n - old_size) * log_n > 2 * n) {
+		HeapPolicy::make_heap(c.begin(), c.end(), comp);
+	  } else {
+		for (size_type i = old_size + 1; i <= n; ++i)
+		  HeapPolicy::push_heap(c.begin(), c.begin() + i, comp);
+	  }
 	} catch (...) {
 	  c.clear();
+	  throw;
 	}
   }
   void pop() {
 	try {
-	  tinystl::pop_heap(c.begin(), c.end(), comp);
+	  HeapPolicy::pop_heap(c.begin(), c.end(), comp);
 	  c.pop_back();
 	} catch (...) {
 	  c.clear();
+	  throw;
+	}
+  }
+  /* 取出堆顶元素并将其移出，top() 只返回 const reference，无法在 pop 之前移走元素 */
+  value_type pop_value() {
+	try {
+	  HeapPolicy::pop_heap(c.begin(), c.end(), comp);
+	  value_type result = std::move(c.back());
+	  c.pop_back();
+	  return result;
+	} catch (...) {
+	  c.clear();
+	  throw;
 	}
   }
 };
 
+template<typename T, size_t D = 4, typename Compare = std::less<T>>
+using d_ary_priority_queue = priority_queue<T, tinystl::vector<T>, Compare, d_ary_heap<D>>;
+
 }  // namespace tinystl
 
 #endif //TINYSTL__PRIORITY_QUEUE_H_
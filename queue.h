@@ -9,6 +9,8 @@
  * 此处以 deque 为底部结构并封闭其头端开口，就能轻松实现
  * 但是同理，以 list 为底部结构并封闭其头端开口也可以，尚待实现 */
 
+#include <utility>
+
 #include "deque.h"
 
 namespace tinystl {
@@ -31,11 +33,22 @@ class queue {
   reference back() { return con.back(); }
   const_reference back() const { return con.back(); }
   void push(const value_type &value) { con.push_back(value); }
+  void push(value_type &&value) { con.push_back(std::move(value)); }
+  template<typename ...Args>
+  void emplace(Args &&...args) { con.emplace_back(std::forward<Args>(args)...); }
   void pop() { con.pop_front(); }
+  /* 取出队首元素并将其移出 */
+  value_type pop_value() {
+	value_type result = std::move(con.front());
+	con.pop_front();
+	return result;
+  }
 
  private:
-  friend bool operator==(const queue &lhs, const queue &rhs);
-  friend bool operator<(const queue &lhs, const queue &rhs);
+  template<typename T1, typename Container1>
+  friend bool operator==(const queue<T1, Container1> &lhs, const queue<T1, Container1> &rhs);
+  template<typename T1, typename Container1>
+  friend bool operator<(const queue<T1, Container1> &lhs, const queue<T1, Container1> &rhs);
 };
 
 template<typename T, typename Container>
@@ -0,0 +1,128 @@
+//
+// Created by polarnight on 26-10-19, 下午5:05.
+//
+
+#ifndef TINYSTL__RADIX_HEAP_H_
+#define TINYSTL__RADIX_HEAP_H_
+
+/* <radix_heap.h> 实现了 radix_priority_queue，一个以无符号整数为键的单调（monotone）最小优先队列
+ * 适用于键值单调不减的场景，例如按时间戳推进的事件调度、边权非负的 Dijkstra：
+ * 每次 push 的键值不得小于最近一次经 top/pop 取得的堆顶键值 last（即 min_key()），否则行为未定义
+ *
+ * 元素按键值与 last 的最高不同位分入 B + 1 个桶（B 为键的位数）：桶 0 存放键值等于 last 的元素，
+ * 桶 i 存放最高不同位为第 i - 1 位的元素。桶 0 为空时，取出最小的非空桶 i，以其中的最小键更新 last，
+ * 再将桶 i 的元素重新分入编号更小的桶。这一步推迟到 top/pop 时才进行，使 last 不会越过调用者尚未看到的堆顶。
+ * 每个元素的桶编号只会单调减小，至多被搬移 B 次，因此 push/pop 的均摊复杂度为 O(B)，对固定位数的键即为 O(1)，且不需要任何元素间的比较
+ *
+ * 接口与 priority_queue 一致（top/push/emplace/pop/pop_value），但 top 为键值最小的元素 */
+
+#include <functional> // for std::_Identity
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+namespace tinystl {
+template<typename Value, typename KeyOfValue = std::_Identity<Value>, typename Allocator = Alloc>
+class radix_priority_queue {
+ public:
+  using value_type = Value;
+  using key_type = typename std::decay<decltype(KeyOfValue()(std::declval<const Value &>()))>::type;
+  using size_type = size_t;
+  using reference = Value &;
+  using const_reference = const Value &;
+
+  static_assert(std::is_integral<key_type>::value && std::is_unsigned<key_type>::value,
+				"radix_priority_queue requires an unsigned integral key");
+
+ private:
+  static constexpr int key_bits = std::numeric_limits<key_type>::digits;
+  using bucket = tinystl::vector<Value, Allocator>;
+
+  mutable bucket buckets[key_bits + 1];
+  mutable key_type last_key; // 即上文的 last，所有元素的键值均不小于它
+  size_type count;
+  KeyOfValue get_key;
+
+  /* 键值 key 与 last_key 的最高不同位决定其所在的桶 */
+  size_type bucket_index(key_type key) const {
+	return key == last_key ? 0 : static_cast<size_type>(std::numeric_limits<unsigned long long>::digits -
+		__builtin_clzll(static_cast<unsigned long long>(key ^ last_key)));
+  }
+  void refill() const;
+
+ public:
+  radix_priority_queue() : last_key(0), count(0) {}
+  template<typename InputIterator>
+  radix_priority_queue(InputIterator first, InputIterator last) : last_key(0), count(0) {
+	for (; first != last; ++first)
+	  push(*first);
+  }
+
+  bool empty() const noexcept { return count == 0; }
+  size_type size() const noexcept { return count; }
+  /* 键值最小的元素 */
+  const_reference top() const {
+	refill();
+	return buckets[0].back();
+  }
+  /* 最近一次经 top/pop 取得的堆顶键值，之后 push 的键值不得小于它 */
+  key_type min_key() const noexcept { return last_key; }
+
+  template<typename ...Args>
+  void emplace(Args &&...args) { push(value_type(std::forward<Args>(args)...)); }
+  void push(const value_type &value) { push(value_type(value)); }
+  void push(value_type &&value) {
+	buckets[bucket_index(get_key(value))].push_back(std::move(value));
+	++count;
+  }
+  void pop() {
+	refill();
+	buckets[0].pop_back();
+	--count;
+  }
+  value_type pop_value() {
+	refill();
+	value_type result = std::move(buckets[0].back());
+	buckets[0].pop_back();
+	--count;
+	return result;
+  }
+  void clear() {
+	for (int i = 0; i <= key_bits; ++i)
+	  buckets[i].clear();
+	count = 0;
+	last_key = 0;
+  }
+  void swap(radix_priority_queue &rhs) {
+	for (int i = 0; i <= key_bits; ++i)
+	  buckets[i].swap(rhs.buckets[i]);
+	std::swap(last_key, rhs.last_key);
+	std::swap(count, rhs.count);
+  }
+};
+
+/* 桶 0 为空时，以最小非空桶中的最小键值作为新的 last，并将该桶的元素重新分桶 */
+template<typename Value, typename KeyOfValue, typename Allocator>
+void radix_priority_queue<Value, KeyOfValue, Allocator>::refill() const {
+  if (!buckets[0].empty())
+	return;
+  int i = 1;
+  while (buckets[i].empty()) ++i;
+  bucket &b = buckets[i];
+  key_type new_last = get_key(b.front());
+  for (typename bucket::iterator it = b.begin() + 1; it != b.end(); ++it) {
+	key_type key = get_key(*it);
+	if (key < new_last)
+	  new_last = key;
+  }
+  last_key = new_last;
+  for (typename bucket::iterator it = b.begin(); it != b.end(); ++it)
+	buckets[bucket_index(get_key(*it))].push_back(std::move(*it));
+  b.clear();
+}
+
+} // namespace tinystl
+
+#endif //TINYSTL__RADIX_HEAP_H_
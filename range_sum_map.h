@@ -0,0 +1,127 @@
+//
+// Created by polarnight on 26-10-19, 下午7:40.
+//
+
+#ifndef TINYSTL__RANGE_SUM_MAP_H_
+#define TINYSTL__RANGE_SUM_MAP_H_
+
+/* <range_sum_map.h> 实现了 range_sum_map，一个可以在 O(log n) 内对任意键值区间的实值求和的 map
+ * 以 rb_tree_summary_augment 在每个节点保存其子树中实值的和（参见 <tree.h>），sum(lo, hi) 不必逐个遍历区间内的元素。
+ * 实值参与了汇总，因此迭代器是只读的，修改实值需通过 assign/add，二者会沿路径向上更新各节点的和。
+ * T 需支持 + 运算，且 T() 为加法的单位元 */
+
+#include <functional>
+
+#include "tree.h"
+
+namespace tinystl {
+template<typename Key, typename T, typename Compare = std::less<Key>, typename Allocator = Alloc>
+class range_sum_map {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using key_compare = Compare;
+
+ private:
+  struct sum_summary {
+	using summary_type = T;
+	static T identity() { return T(); }
+	static T make(const value_type &v) { return v.second; }
+	static T combine(const T &a, const T &b) { return a + b; }
+  };
+
+  using base_ptr = rb_tree<key_type, value_type, std::_Select1st<value_type>, key_compare, Allocator,
+						   rb_tree_summary_augment<sum_summary>>;
+  base_ptr tree;
+
+ public:
+  using pointer = typename base_ptr::const_pointer;
+  using const_pointer = typename base_ptr::const_pointer;
+  using reference = typename base_ptr::const_reference;
+  using const_reference = typename base_ptr::const_reference;
+  // 实值参与求和，不允许通过迭代器修改
+  using iterator = typename base_ptr::const_iterator;
+  using const_iterator = typename base_ptr::const_iterator;
+  using difference_type = typename base_ptr::difference_type;
+  using size_type = typename base_ptr::size_type;
+
+  range_sum_map() : tree(Compare()) {}
+  explicit range_sum_map(const Compare &comp) : tree(comp) {}
+  template<typename InputIterator>
+  range_sum_map(InputIterator first, InputIterator last) : tree(Compare()) { tree.insert_unique(first, last); }
+  range_sum_map(const range_sum_map &x) : tree(x.tree) {}
+  range_sum_map &operator=(const range_sum_map &x) {
+	tree = x.tree;
+	return *this;
+  }
+
+  /* accessor 相关操作 */
+  key_compare key_comp() const { return tree.key_comp(); }
+  iterator begin() const { return tree.begin(); }
+  iterator end() const { return tree.end(); }
+  bool empty() const { return tree.empty(); }
+  size_type size() const { return tree.size(); }
+  size_type max_size() const { return tree.max_size(); }
+  void swap(range_sum_map &x) { tree.swap(x.tree); }
+
+  /* container 相关操作 */
+  std::pair<iterator, bool> insert(const value_type &x) {
+	std::pair<typename base_ptr::iterator, bool> p = tree.insert_unique(x);
+	return std::pair<iterator, bool>(p.first, p.second);
+  }
+  template<typename InputIterator>
+  void insert(InputIterator first, InputIterator last) { tree.insert_unique(first, last); }
+  /* 将键值 k 的实值设为 value，k 不存在时插入 */
+  iterator assign(const key_type &k, const mapped_type &value) {
+	std::pair<typename base_ptr::iterator, bool> p = tree.insert_unique(value_type(k, value));
+	if (!p.second) {
+	  p.first->second = value;
+	  tree.refresh(p.first);
+	}
+	return p.first;
+  }
+  /* 将键值 k 的实值加上 delta，k 不存在时以 T() + delta 插入 */
+  iterator add(const key_type &k, const mapped_type &delta) {
+	std::pair<typename base_ptr::iterator, bool> p = tree.insert_unique(value_type(k, T() + delta));
+	if (!p.second) {
+	  p.first->second = p.first->second + delta;
+	  tree.refresh(p.first);
+	}
+	return p.first;
+  }
+  void erase(iterator position) {
+	using base_iterator = typename base_ptr::iterator;
+	tree.erase(base_iterator(position));
+  }
+  size_type erase(const key_type &x) { return tree.erase(x); }
+  void erase(iterator first, iterator last) {
+	using base_iterator = typename base_ptr::iterator;
+	tree.erase(base_iterator(first), base_iterator(last));
+  }
+  void clear() { tree.clear(); }
+
+  /* operator 相关操作 */
+  iterator find(const key_type &x) const { return tree.find(x); }
+  size_type count(const key_type &x) const { return tree.count(x); }
+  iterator lower_bound(const key_type &x) const { return tree.lower_bound(x); }
+  iterator upper_bound(const key_type &x) const { return tree.upper_bound(x); }
+  std::pair<iterator, iterator> equal_range(const key_type &x) const { return tree.equal_range(x); }
+
+  /* 全部实值的和，O(1) */
+  mapped_type sum() const { return tree.aggregate(); }
+  /* 键值在 [lo, hi) 内的实值的和，O(log n) */
+  mapped_type sum(const key_type &lo, const key_type &hi) const { return tree.aggregate(lo, hi); }
+
+  friend bool operator==(const range_sum_map &lhs, const range_sum_map &rhs) { return lhs.tree == rhs.tree; }
+  friend bool operator!=(const range_sum_map &lhs, const range_sum_map &rhs) { return !(lhs.tree == rhs.tree); }
+}; // class range_sum_map end
+
+template<typename Key, typename T, typename Compare, typename Allocator>
+inline void swap(range_sum_map<Key, T, Compare, Allocator> &lhs, range_sum_map<Key, T, Compare, Allocator> &rhs) {
+  lhs.swap(rhs);
+}
+
+} // namespace tinystl
+
+#endif //TINYSTL__RANGE_SUM_MAP_H_
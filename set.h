@@ -15,7 +15,8 @@
 
 namespace tinystl {
 /* 缺省情况下采用递增排序 */
-template<typename Key, typename Compare = std::less<Key>, typename Allocator = Alloc>
+template<typename Key, typename Compare = std::less<Key>, typename Allocator = Alloc,
+		 typename Augment = rb_tree_no_augment>
 class set {
  public:
   using key_type = Key;
@@ -25,8 +26,8 @@ class set {
   using value_compare = Compare;
 
  private:
-  using base_ptr = rb_tree<key_type, value_type, std::_Identity<value_type>, key_compare, Allocator>;
-  base_ptr rb_tree;
+  using base_ptr = rb_tree<key_type, value_type, std::_Identity<value_type>, key_compare, Allocator, Augment>;
+  base_ptr tree;
 
  public:
   using pointer = typename base_ptr::const_pointer;
@@ -38,107 +39,144 @@ class set {
   using const_iterator = typename base_ptr::const_iterator;
   using difference_type = typename base_ptr::difference_type;
   using size_type = typename base_ptr::size_type;
+  using node_type = typename base_ptr::node_type;
+  using insert_return_type = rb_tree_insert_return<iterator, node_type>;
 
-  set() : rb_tree(Compare()) {}
-  explicit set(const Compare &comp) : rb_tree(comp) {}
+  set() : tree(Compare()) {}
+  explicit set(const Compare &comp) : tree(comp) {}
   template<typename InputIterator>
-  set(InputIterator first, InputIterator last) : rb_tree(Compare()) { rb_tree.insert_unique(first, last); }
+  set(InputIterator first, InputIterator last) : tree(Compare()) { tree.insert_unique(first, last); }
   template<typename InputIterator>
-  set(InputIterator first, InputIterator last, const Compare &comp) : rb_tree(comp) {
-	rb_tree.insert_unique(first,
+  set(InputIterator first, InputIterator last, const Compare &comp) : tree(comp) {
+	tree.insert_unique(first,
 						  last);
   }
-  explicit set(const set<Key, Compare, Alloc> &x) : rb_tree(x.rb_tree) {}
+  set(const set &x) : tree(x.tree) {}
   set &operator=(const set &x) {
-	rb_tree = x.rb_tree;
+	tree = x.tree;
 	return *this;
   }
 
   /* 以下为 set 所有操作，由于 <tree.h> 中的 RB-tree 实现均已提供，此处只做调用 */
 
   /* accessor 相关操作 */
-  key_compare key_comp() const { return rb_tree.key_comp(); }
+  key_compare key_comp() const { return tree.key_comp(); }
   value_compare value_comp() const { return key_comp(); }
-  iterator begin() const { return rb_tree.begin(); }
-  iterator end() const { return rb_tree.end(); }
-  bool empty() const { return rb_tree.empty(); }
-  size_type size() const { return rb_tree.size(); }
-  size_type max_size() const { return rb_tree.max_size(); }
-  void swap(set<Key, Compare, Alloc> &x) { rb_tree.swap(x.rb_tree); }
+  iterator begin() const { return tree.begin(); }
+  iterator end() const { return tree.end(); }
+  bool empty() const { return tree.empty(); }
+  size_type size() const { return tree.size(); }
+  size_type max_size() const { return tree.max_size(); }
+  void swap(set &x) { tree.swap(x.tree); }
 
   /* container 相关操作 */
   using pair_iterator_boll = std::pair<iterator, bool>;
 
   pair_iterator_boll insert(const value_type &x) {
-	std::pair<typename base_ptr::iterator, bool> p = rb_tree.insert_unique(x);
+	std::pair<typename base_ptr::iterator, bool> p = tree.insert_unique(x);
 	return pair_iterator_boll(p.first, p.second);
   }
   iterator insert(iterator position, const value_type &x) {
 	using base_iterator = typename base_ptr::iterator;
-	return rb_tree.insert_unique(static_cast<base_iterator &>(position), x);
+	return tree.insert_unique(base_iterator(position), x);
   }
   template<typename InputIterator>
-  void insert(InputIterator first, InputIterator last) { rb_tree.insert_unique(first, last); }
+  void insert(InputIterator first, InputIterator last) { tree.insert_unique(first, last); }
+  /* 追加有序的区间，区间中的键值大于已有的键值时为 O(k + log n)（参见 <tree.h>） */
+  template<typename InputIterator>
+  void append_sorted(InputIterator first, InputIterator last) { tree.append_sorted_unique(first, last); }
   void erase(iterator position) {
 	using base_iterator = typename base_ptr::iterator;
-	rb_tree.erase(static_cast<base_iterator &>(position));
+	tree.erase(base_iterator(position));
   }
-  size_type erase(const key_type &x) { return rb_tree.erase(x); }
+  size_type erase(const key_type &x) { return tree.erase(x); }
   void erase(iterator first, iterator last) {
 	using base_iterator = typename base_ptr::iterator;
-	rb_tree.erase(static_cast<base_iterator &>(first), static_cast<base_iterator &>(last));
+	tree.erase(base_iterator(first), base_iterator(last));
+  }
+  void clear() { tree.clear(); }
+
+  /* 节点句柄相关操作，节点在容器之间移动时不重新配置，也不复制元素（参见 <tree.h>） */
+  node_type extract(iterator position) {
+	using base_iterator = typename base_ptr::iterator;
+	return tree.extract(base_iterator(position));
+  }
+  node_type extract(const key_type &x) { return tree.extract(x); }
+  insert_return_type insert(node_type &&nh) {
+	typename base_ptr::insert_return_type r = tree.insert_unique(std::move(nh));
+	return insert_return_type{r.position, r.inserted, std::move(r.node)};
   }
-  void clear() { rb_tree.clear(); }
+  void merge(set &source) { tree.merge_unique(source.tree); }
+
+  /* 集合操作，以 *this 与 x 的运算结果取代 *this 的内容并清空 x，节点直接在两棵树间移动而不重新配置（参见 <tree.h>）
+   * 键值相同时 set_union 保留 *this 中的元素；
+   * split 将键值不小于 k 的元素移入 x，join 将 x 的元素全部移入 *this，要求 *this 中的键值均不大于 x 中的键值；
+   * 集合运算传入 <parallel_tree.h> 的 parallel_tree_fork 时以线程池并行执行 */
+  void split(const key_type &k, set &x) { tree.split(k, x.tree); }
+  void join(set &x) { tree.join(x.tree); }
+  template<typename Fork = rb_tree_serial_fork>
+  void set_union(set &x, Fork fork = Fork()) { tree.union_unique(x.tree, fork); }
+  template<typename Fork = rb_tree_serial_fork>
+  void set_intersection(set &x, Fork fork = Fork()) { tree.intersection(x.tree, fork); }
+  template<typename Fork = rb_tree_serial_fork>
+  void set_difference(set &x, Fork fork = Fork()) { tree.difference(x.tree, fork); }
 
   /* operator 相关操作 */
-  iterator find(const key_type &x) const { return rb_tree.find(x); }
-  size_type count(const key_type &x) const { return rb_tree.count(x); }
-  iterator lower_bound(const key_type &x) const { return rb_tree.lower_bound(x); }
-  iterator upper_bound(const key_type &x) const { return rb_tree.upper_bound(x); }
-  std::pair<iterator, iterator> equal_range(const key_type &x) const { return rb_tree.equal_range(x); }
-  friend bool operator==(const set &lhs, const set &rhs) { return lhs.rb_tree == rhs.rb_tree; }
-  friend bool operator<(const set &lhs, const set &rhs) { return lhs.rb_tree < rhs.rb_tree; }
+  iterator find(const key_type &x) const { return tree.find(x); }
+  size_type count(const key_type &x) const { return tree.count(x); }
+  iterator lower_bound(const key_type &x) const { return tree.lower_bound(x); }
+  iterator upper_bound(const key_type &x) const { return tree.upper_bound(x); }
+  std::pair<const_iterator, const_iterator> equal_range(const key_type &x) const { return tree.equal_range(x); }
+
+  /* 顺序统计，要求 Augment 提供子树大小，如 rb_tree_size_augment（参见 <tree.h>），均为 O(log n) */
+  iterator select(size_type n) const { return tree.select(n); }
+  size_type rank(const key_type &x) const { return tree.rank(x); }
+  size_type index_of(iterator position) const { return tree.index_of(position); }
+  difference_type distance(iterator first, iterator last) const { return tree.distance(first, last); }
+  friend bool operator==(const set &lhs, const set &rhs) { return lhs.tree == rhs.tree; }
+  friend bool operator<(const set &lhs, const set &rhs) { return lhs.tree < rhs.tree; }
 }; // class set end
 
 /* 重载函数 */
-template<typename Key, typename Compare, typename Allocator>
-bool operator==(const set<Key, Compare, Allocator> &lhs, const set<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename Compare, typename Allocator, typename Augment>
+bool operator==(const set<Key, Compare, Allocator, Augment> &lhs, const set<Key, Compare, Allocator, Augment> &rhs) {
   return lhs == rhs;
 }
 
-template<typename Key, typename Compare, typename Allocator>
-bool operator<(const set<Key, Compare, Allocator> &lhs, const set<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename Compare, typename Allocator, typename Augment>
+bool operator<(const set<Key, Compare, Allocator, Augment> &lhs, const set<Key, Compare, Allocator, Augment> &rhs) {
   return lhs < rhs;
 }
 
-template<typename Key, typename Compare, typename Allocator>
-bool operator!=(const set<Key, Compare, Allocator> &lhs, const set<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename Compare, typename Allocator, typename Augment>
+bool operator!=(const set<Key, Compare, Allocator, Augment> &lhs, const set<Key, Compare, Allocator, Augment> &rhs) {
   return !(lhs == rhs);
 }
 
-template<typename Key, typename Compare, typename Allocator>
-bool operator>(const set<Key, Compare, Allocator> &lhs, const set<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename Compare, typename Allocator, typename Augment>
+bool operator>(const set<Key, Compare, Allocator, Augment> &lhs, const set<Key, Compare, Allocator, Augment> &rhs) {
   return rhs < lhs;
 }
 
-template<typename Key, typename Compare, typename Allocator>
-bool operator<=(const set<Key, Compare, Allocator> &lhs, const set<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename Compare, typename Allocator, typename Augment>
+bool operator<=(const set<Key, Compare, Allocator, Augment> &lhs, const set<Key, Compare, Allocator, Augment> &rhs) {
   return !(rhs < lhs);
 }
 
-template<typename Key, typename Compare, typename Allocator>
-bool operator>=(const set<Key, Compare, Allocator> &lhs, const set<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename Compare, typename Allocator, typename Augment>
+bool operator>=(const set<Key, Compare, Allocator, Augment> &lhs, const set<Key, Compare, Allocator, Augment> &rhs) {
   return !(lhs < rhs);
 }
 
-template<typename Key, typename Compare, typename Allocator>
-void swap(const set<Key, Compare, Allocator> &lhs, const set<Key, Compare, Allocator> &rhs) noexcept {
+template<typename Key, typename Compare, typename Allocator, typename Augment>
+void swap(set<Key, Compare, Allocator, Augment> &lhs, set<Key, Compare, Allocator, Augment> &rhs) noexcept {
   lhs.swap(rhs);
 }
 
 /********************************************************************************************************************/
 
-template<typename Key, typename Compare = std::less<Key>, typename Allocator = Alloc>
+template<typename Key, typename Compare = std::less<Key>, typename Allocator = Alloc,
+		 typename Augment = rb_tree_no_augment>
 class multiset {
  public:
   using key_type = Key;
@@ -148,8 +186,8 @@ class multiset {
   using value_compare = Compare;
 
  private:
-  using base_ptr = rb_tree<key_type, value_type, std::_Identity<value_type>, key_compare, Allocator>;
-  base_ptr rb_tree;
+  using base_ptr = rb_tree<key_type, value_type, std::_Identity<value_type>, key_compare, Allocator, Augment>;
+  base_ptr tree;
 
  public:
   using pointer = typename base_ptr::const_pointer;
@@ -161,101 +199,128 @@ class multiset {
   using const_iterator = typename base_ptr::const_iterator;
   using difference_type = typename base_ptr::difference_type;
   using size_type = typename base_ptr::size_type;
+  using node_type = typename base_ptr::node_type;
 
-  multiset() : rb_tree(Compare()) {}
-  explicit multiset(const Compare &comp) : rb_tree(comp) {}
+  multiset() : tree(Compare()) {}
+  explicit multiset(const Compare &comp) : tree(comp) {}
   template<typename InputIterator>
-  multiset(InputIterator first, InputIterator last) : rb_tree(Compare()) { rb_tree.insert_equal(first, last); }
+  multiset(InputIterator first, InputIterator last) : tree(Compare()) { tree.insert_equal(first, last); }
   template<typename InputIterator>
-  multiset(InputIterator first, InputIterator last, const Compare &comp) : rb_tree(comp) {
-	rb_tree.insert_equal(first,
+  multiset(InputIterator first, InputIterator last, const Compare &comp) : tree(comp) {
+	tree.insert_equal(first,
 						 last);
   }
-  explicit multiset(const set<Key, Compare, Alloc> &x) : rb_tree(x.rb_tree) {}
+  multiset(const multiset &x) : tree(x.tree) {}
   multiset &operator=(const multiset &x) {
-	rb_tree = x.rb_tree;
+	tree = x.tree;
 	return *this;
   }
 
   /* 以下为 multiset 所有操作，由于 <tree.h> 中的 RB-tree 实现均已提供，此处只做调用 */
 
   /* accessor 相关操作 */
-  key_compare key_comp() const { return rb_tree.key_comp(); }
+  key_compare key_comp() const { return tree.key_comp(); }
   value_compare value_comp() const { return key_comp(); }
-  iterator begin() const { return rb_tree.begin(); }
-  iterator end() const { return rb_tree.end(); }
-  bool empty() const { return rb_tree.empty(); }
-  size_type size() const { return rb_tree.size(); }
-  size_type max_size() const { return rb_tree.max_size(); }
-  void swap(set<Key, Compare, Alloc> &x) { rb_tree.swap(x.rb_tree); }
+  iterator begin() const { return tree.begin(); }
+  iterator end() const { return tree.end(); }
+  bool empty() const { return tree.empty(); }
+  size_type size() const { return tree.size(); }
+  size_type max_size() const { return tree.max_size(); }
+  void swap(multiset &x) { tree.swap(x.tree); }
 
   /* container 相关操作 */
   using pair_iterator_boll = std::pair<iterator, bool>;
 
-  pair_iterator_boll insert(const value_type &x) {
-	std::pair<typename base_ptr::iterator, bool> p = rb_tree.insert_equal(x);
-	return pair_iterator_boll(p.first, p.second);
-  }
+  iterator insert(const value_type &x) { return tree.insert_equal(x); }
   iterator insert(iterator position, const value_type &x) {
 	using base_iterator = typename base_ptr::iterator;
-	return rb_tree.insert_equal(static_cast<base_iterator &>(position), x);
+	return tree.insert_equal(base_iterator(position), x);
   }
   template<typename InputIterator>
-  void insert(InputIterator first, InputIterator last) { rb_tree.insert_equal(first, last); }
+  void insert(InputIterator first, InputIterator last) { tree.insert_equal(first, last); }
+  /* 追加有序的区间，区间中的键值大于已有的键值时为 O(k + log n)（参见 <tree.h>） */
+  template<typename InputIterator>
+  void append_sorted(InputIterator first, InputIterator last) { tree.append_sorted_equal(first, last); }
   void erase(iterator position) {
 	using base_iterator = typename base_ptr::iterator;
-	rb_tree.erase(static_cast<base_iterator &>(position));
+	tree.erase(base_iterator(position));
   }
-  size_type erase(const key_type &x) { return rb_tree.erase(x); }
+  size_type erase(const key_type &x) { return tree.erase(x); }
   void erase(iterator first, iterator last) {
 	using base_iterator = typename base_ptr::iterator;
-	rb_tree.erase(static_cast<base_iterator &>(first), static_cast<base_iterator &>(last));
+	tree.erase(base_iterator(first), base_iterator(last));
+  }
+  void clear() { tree.clear(); }
+
+  /* 节点句柄相关操作，节点在容器之间移动时不重新配置，也不复制元素（参见 <tree.h>） */
+  node_type extract(iterator position) {
+	using base_iterator = typename base_ptr::iterator;
+	return tree.extract(base_iterator(position));
   }
-  void clear() { rb_tree.clear(); }
+  node_type extract(const key_type &x) { return tree.extract(x); }
+  iterator insert(node_type &&nh) { return tree.insert_equal(std::move(nh)); }
+  void merge(multiset &source) { tree.merge_equal(source.tree); }
+
+  /* 集合操作，与 set 相同，但 set_union 保留两者的全部元素，
+   * set_intersection/set_difference 则按键值是否在 x 中出现决定 *this 中每个元素的去留 */
+  void split(const key_type &k, multiset &x) { tree.split(k, x.tree); }
+  void join(multiset &x) { tree.join(x.tree); }
+  template<typename Fork = rb_tree_serial_fork>
+  void set_union(multiset &x, Fork fork = Fork()) { tree.union_equal(x.tree, fork); }
+  template<typename Fork = rb_tree_serial_fork>
+  void set_intersection(multiset &x, Fork fork = Fork()) { tree.intersection(x.tree, fork); }
+  template<typename Fork = rb_tree_serial_fork>
+  void set_difference(multiset &x, Fork fork = Fork()) { tree.difference(x.tree, fork); }
 
   /* operator 相关操作 */
-  iterator find(const key_type &x) const { return rb_tree.find(x); }
-  size_type count(const key_type &x) const { return rb_tree.count(x); }
-  iterator lower_bound(const key_type &x) const { return rb_tree.lower_bound(x); }
-  iterator upper_bound(const key_type &x) const { return rb_tree.upper_bound(x); }
-  std::pair<iterator, iterator> equal_range(const key_type &x) const { return rb_tree.equal_range(x); }
-  friend bool operator==(const multiset &lhs, const multiset &rhs) { return lhs.tree_ == rhs.tree_; }
-  friend bool operator<(const multiset &lhs, const multiset &rhs) { return lhs.tree_ < rhs.tree_; }
+  iterator find(const key_type &x) const { return tree.find(x); }
+  size_type count(const key_type &x) const { return tree.count(x); }
+  iterator lower_bound(const key_type &x) const { return tree.lower_bound(x); }
+  iterator upper_bound(const key_type &x) const { return tree.upper_bound(x); }
+  std::pair<const_iterator, const_iterator> equal_range(const key_type &x) const { return tree.equal_range(x); }
+
+  /* 顺序统计，要求 Augment 提供子树大小，如 rb_tree_size_augment（参见 <tree.h>），均为 O(log n) */
+  iterator select(size_type n) const { return tree.select(n); }
+  size_type rank(const key_type &x) const { return tree.rank(x); }
+  size_type index_of(iterator position) const { return tree.index_of(position); }
+  difference_type distance(iterator first, iterator last) const { return tree.distance(first, last); }
+  friend bool operator==(const multiset &lhs, const multiset &rhs) { return lhs.tree == rhs.tree; }
+  friend bool operator<(const multiset &lhs, const multiset &rhs) { return lhs.tree < rhs.tree; }
 }; // class multiset end
 
 /* 重载函数 */
-template<typename Key, typename Compare, typename Allocator>
-bool operator==(const multiset<Key, Compare, Allocator> &lhs, const multiset<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename Compare, typename Allocator, typename Augment>
+bool operator==(const multiset<Key, Compare, Allocator, Augment> &lhs, const multiset<Key, Compare, Allocator, Augment> &rhs) {
   return lhs == rhs;
 }
 
-template<typename Key, typename Compare, typename Allocator>
-bool operator<(const multiset<Key, Compare, Allocator> &lhs, const multiset<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename Compare, typename Allocator, typename Augment>
+bool operator<(const multiset<Key, Compare, Allocator, Augment> &lhs, const multiset<Key, Compare, Allocator, Augment> &rhs) {
   return lhs < rhs;
 }
 
-template<typename Key, typename Compare, typename Allocator>
-bool operator!=(const multiset<Key, Compare, Allocator> &lhs, const multiset<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename Compare, typename Allocator, typename Augment>
+bool operator!=(const multiset<Key, Compare, Allocator, Augment> &lhs, const multiset<Key, Compare, Allocator, Augment> &rhs) {
   return !(lhs == rhs);
 }
 
-template<typename Key, typename Compare, typename Allocator>
-bool operator>(const multiset<Key, Compare, Allocator> &lhs, const multiset<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename Compare, typename Allocator, typename Augment>
+bool operator>(const multiset<Key, Compare, Allocator, Augment> &lhs, const multiset<Key, Compare, Allocator, Augment> &rhs) {
   return rhs < lhs;
 }
 
-template<typename Key, typename Compare, typename Allocator>
-bool operator<=(const multiset<Key, Compare, Allocator> &lhs, const multiset<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename Compare, typename Allocator, typename Augment>
+bool operator<=(const multiset<Key, Compare, Allocator, Augment> &lhs, const multiset<Key, Compare, Allocator, Augment> &rhs) {
   return !(rhs < lhs);
 }
 
-template<typename Key, typename Compare, typename Allocator>
-bool operator>=(const multiset<Key, Compare, Allocator> &lhs, const multiset<Key, Compare, Allocator> &rhs) {
+template<typename Key, typename Compare, typename Allocator, typename Augment>
+bool operator>=(const multiset<Key, Compare, Allocator, Augment> &lhs, const multiset<Key, Compare, Allocator, Augment> &rhs) {
   return !(lhs < rhs);
 }
 
-template<typename Key, typename Compare, typename Allocator>
-void swap(const multiset<Key, Compare, Allocator> &lhs, const multiset<Key, Compare, Allocator> &rhs) noexcept {
+template<typename Key, typename Compare, typename Allocator, typename Augment>
+void swap(multiset<Key, Compare, Allocator, Augment> &lhs, multiset<Key, Compare, Allocator, Augment> &rhs) noexcept {
   lhs.swap(rhs);
 }
 
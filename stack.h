@@ -7,9 +7,14 @@
 
 /* <stack.h> 实现了 stack
  * 此处以 deque 为底部结构并封闭其头端开口，就能轻松实现
- * 但是同理，以 list 为底部结构并封闭其头端开口也可以，尚待实现 */
+ * 同理，任何提供 back/push_back/pop_back 的序列式容器都可作为底部结构，例如 list 与 vector
+ * vector_stack 以 vector 为底部结构，元素连续存放，push/pop 只是移动尾指针，适合深度优先搜索这类频繁进出栈的场景，
+ * 但 pop 不会归还空间，且扩容时需要搬移全部元素，可先以 reserve 预留空间 */
+
+#include <utility>
 
 #include "deque.h"
+#include "vector.h"
 
 namespace tinystl {
 
@@ -30,13 +35,23 @@ class stack {
   reference top() { return con.back(); }
   const_reference top() const { return con.back(); }
   void push(const value_type &value) { con.push_back(value); }
+  void push(value_type &&value) { con.push_back(std::move(value)); }
+  template<typename ...Args>
+  void emplace(Args &&...args) { con.emplace_back(std::forward<Args>(args)...); }
   void pop() { con.pop_back(); }
+  /* 仅当底部结构提供 reserve 时可用，例如 vector */
+  void reserve(size_type n) { con.reserve(n); }
 
  private:
-  friend bool operator==(const stack &lhs, const stack &rhs);
-  friend bool operator<(const stack &lhs, const stack &rhs);
+  template<typename T1, typename Container1>
+  friend bool operator==(const stack<T1, Container1> &lhs, const stack<T1, Container1> &rhs);
+  template<typename T1, typename Container1>
+  friend bool operator<(const stack<T1, Container1> &lhs, const stack<T1, Container1> &rhs);
 };
 
+template<typename T>
+using vector_stack = stack<T, tinystl::vector<T>>;
+
 template<typename T, typename Container>
 bool operator==(const stack<T, Container> &lhs,
 				const stack<T, Container> &rhs) {
@@ -0,0 +1,289 @@
+//
+// Created by polarnight on 26-10-19, 下午2:45.
+//
+
+#ifndef TINYSTL__THREAD_POOL_H_
+#define TINYSTL__THREAD_POOL_H_
+
+/* <thread_pool.h> 实现了一个固定线程数的工作窃取线程池，以及用于 fork-join 的 task_group
+ * 每个 worker 拥有一个 work_stealing_deque：
+ *   worker 中提交的任务压入自己的队列底端，并优先从底端取出，后进先出，有利于缓存局部性；
+ *   自己的队列为空时，先查看由外部线程提交任务的 injection 队列，再随机挑选其他 worker 从顶端窃取。
+ * 长时间找不到任务的 worker 在条件变量上休眠，提交任务时只有存在休眠者才需要加锁唤醒 */
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "concurrent_queue.h"
+#include "work_stealing_deque.h"
+
+namespace tinystl {
+class thread_pool {
+ private:
+  /* 类型擦除后的任务，以指针的形式在队列间传递 */
+  struct task_base {
+	virtual ~task_base() = default;
+	virtual void run() = 0;
+  };
+  template<typename Function>
+  struct task_impl : task_base {
+	Function fn;
+	explicit task_impl(Function &&f) : fn(std::move(f)) {}
+	explicit task_impl(const Function &f) : fn(f) {}
+	void run() override { fn(); }
+  };
+
+  struct worker {
+	work_stealing_deque<task_base *> queue;
+	std::thread thread;
+	unsigned seed; // 挑选窃取对象的随机数种子
+  };
+
+  /* 当前线程所属的 pool 及其在 pool 中的编号，非 worker 线程的 pool 为 nullptr */
+  struct worker_context {
+	thread_pool *pool = nullptr;
+	size_t index = 0;
+  };
+  static worker_context &context() {
+	static thread_local worker_context ctx;
+	return ctx;
+  }
+
+  static constexpr size_t injection_capacity = 4096;
+  static constexpr int spin_count = 64;
+
+  worker *workers;
+  size_t worker_count;
+  mpmc_queue<task_base *> injection;
+  alignas(cache_line_size) std::atomic<size_t> pending; // 已提交但尚未被取走的任务数
+  alignas(cache_line_size) std::atomic<size_t> sleeping;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool stop;
+
+  void submit_task(task_base *t);
+  bool take_task(task_base *&t);
+  void worker_loop(size_t index);
+  static void execute(task_base *t);
+
+ public:
+  static size_t default_thread_count() {
+	unsigned n = std::thread::hardware_concurrency();
+	return n != 0 ? n : 1;
+  }
+
+  explicit thread_pool(size_t thread_count = default_thread_count());
+  thread_pool(const thread_pool &) = delete;
+  thread_pool &operator=(const thread_pool &) = delete;
+  ~thread_pool();
+
+  size_t size() const noexcept { return worker_count; }
+  /* 当前线程是否为本 pool 的 worker */
+  bool in_worker() const { return context().pool == this; }
+
+  /* 提交一个任务，不等待其完成；任务抛出的异常会终止程序，需要异常传递时请使用 task_group */
+  template<typename Function>
+  void submit(Function &&f) {
+	submit_task(new task_impl<typename std::decay<Function>::type>(std::forward<Function>(f)));
+  }
+  /* 在当前线程中执行一个待执行的任务，没有任务时返回 false，供等待者在等待期间帮忙 */
+  bool run_one();
+};
+
+inline thread_pool::thread_pool(size_t thread_count)
+	: workers(nullptr), worker_count(thread_count != 0 ? thread_count : 1), injection(injection_capacity),
+	  stop(false) {
+  pending.store(0, std::memory_order_relaxed);
+  sleeping.store(0, std::memory_order_relaxed);
+  workers = new worker[worker_count];
+  size_t started = 0;
+  try {
+	for (; started < worker_count; ++started) {
+	  workers[started].seed = static_cast<unsigned>(started * 2654435761u + 1);
+	  workers[started].thread = std::thread(&thread_pool::worker_loop, this, started);
+	}
+  } catch (...) {
+	{
+	  std::lock_guard<std::mutex> lock(mutex);
+	  stop = true;
+	}
+	cv.notify_all();
+	for (size_t i = 0; i < started; ++i)
+	  workers[i].thread.join();
+	delete[] workers;
+	throw;
+  }
+}
+
+inline thread_pool::~thread_pool() {
+  {
+	std::lock_guard<std::mutex> lock(mutex);
+	stop = true;
+  }
+  cv.notify_all();
+  for (size_t i = 0; i < worker_count; ++i)
+	workers[i].thread.join();
+  delete[] workers;
+}
+
+inline void thread_pool::submit_task(task_base *t) {
+  // 先计数再入队，保证任务被取走时 pending 不会下溢
+  pending.fetch_add(1, std::memory_order_seq_cst);
+  worker_context &ctx = context();
+  if (ctx.pool == this)
+	workers[ctx.index].queue.push(t);
+  else
+	injection.push(t);
+  // 与 worker_loop 中先递增 sleeping 再检查 pending 的顺序配对，保证不会丢失唤醒
+  if (sleeping.load(std::memory_order_seq_cst) != 0) {
+	{ std::lock_guard<std::mutex> lock(mutex); }
+	cv.notify_one();
+  }
+}
+
+inline bool thread_pool::take_task(task_base *&t) {
+  worker_context &ctx = context();
+  size_t self = worker_count;
+  if (ctx.pool == this) {
+	self = ctx.index;
+	if (workers[self].queue.try_pop(t)) {
+	  pending.fetch_sub(1, std::memory_order_relaxed);
+	  return true;
+	}
+  }
+  if (injection.try_pop(t)) {
+	pending.fetch_sub(1, std::memory_order_relaxed);
+	return true;
+  }
+  // 从随机的位置开始依次尝试窃取其他 worker
+  size_t start = 0;
+  if (self != worker_count) {
+	unsigned &seed = workers[self].seed;
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	start = seed % worker_count;
+  }
+  for (size_t i = 0; i < worker_count; ++i) {
+	size_t victim = (start + i) % worker_count;
+	if (victim != self && workers[victim].queue.try_steal(t)) {
+	  pending.fetch_sub(1, std::memory_order_relaxed);
+	  return true;
+	}
+  }
+  return false;
+}
+
+inline void thread_pool::execute(task_base *t) {
+  struct task_guard {
+	task_base *t;
+	~task_guard() { delete t; }
+  } guard{t};
+  t->run();
+}
+
+inline bool thread_pool::run_one() {
+  task_base *t;
+  if (!take_task(t))
+	return false;
+  execute(t);
+  return true;
+}
+
+inline void thread_pool::worker_loop(size_t index) {
+  context().pool = this;
+  context().index = index;
+  for (;;) {
+	if (run_one())
+	  continue;
+	bool found = false;
+	for (int i = 0; i < spin_count && !found; ++i) {
+	  std::this_thread::yield();
+	  found = run_one();
+	}
+	if (found)
+	  continue;
+	std::unique_lock<std::mutex> lock(mutex);
+	sleeping.fetch_add(1, std::memory_order_seq_cst);
+	cv.wait(lock, [this] { return pending.load(std::memory_order_seq_cst) != 0 || stop; });
+	sleeping.fetch_sub(1, std::memory_order_relaxed);
+	if (stop && pending.load(std::memory_order_relaxed) == 0)
+	  return;
+  }
+}
+
+/* 进程内共享的缺省线程池，线程数等于硬件线程数，首次使用时创建 */
+inline thread_pool &default_thread_pool() {
+  static thread_pool pool;
+  return pool;
+}
+
+/********************************************************************************************************************/
+
+/* task_group
+ * 将一组任务提交到线程池，wait 等待它们全部完成。在 worker 中等待时当前线程也会执行池中的任务，
+ * 因此可以在任务内部嵌套使用 task_group 而不会因 worker 全部阻塞而死锁。
+ * 任务抛出的第一个异常会在 wait 中重新抛出，其余异常被忽略 */
+class task_group {
+ private:
+  thread_pool &pool;
+  alignas(cache_line_size) std::atomic<size_t> unfinished;
+  std::atomic<bool> has_error;
+  std::exception_ptr error;
+
+  void wait_all() {
+	// 外部线程只能从 injection 队列按先进先出取任务，取到的多是与自己无关的大任务，
+	// 在其中继续嵌套等待会使栈无限增长，因此只有 worker 在等待期间帮忙
+	const bool help = pool.in_worker();
+	while (unfinished.load(std::memory_order_acquire) != 0)
+	  if (!help || !pool.run_one())
+		std::this_thread::yield();
+  }
+
+ public:
+  explicit task_group(thread_pool &p = default_thread_pool()) : pool(p) {
+	unfinished.store(0, std::memory_order_relaxed);
+	has_error.store(false, std::memory_order_relaxed);
+  }
+  task_group(const task_group &) = delete;
+  task_group &operator=(const task_group &) = delete;
+  ~task_group() { wait_all(); }
+
+  template<typename Function>
+  void run(Function &&f) {
+	unfinished.fetch_add(1, std::memory_order_relaxed);
+	try {
+	  pool.submit([this, fn = typename std::decay<Function>::type(std::forward<Function>(f))]() mutable {
+		try {
+		  fn();
+		} catch (...) {
+		  if (!has_error.exchange(true, std::memory_order_relaxed))
+			error = std::current_exception();
+		}
+		unfinished.fetch_sub(1, std::memory_order_release);
+	  });
+	} catch (...) {
+	  unfinished.fetch_sub(1, std::memory_order_relaxed);
+	  throw;
+	}
+  }
+
+  void wait() {
+	wait_all();
+	if (has_error.load(std::memory_order_relaxed)) {
+	  has_error.store(false, std::memory_order_relaxed);
+	  std::exception_ptr e = error;
+	  error = nullptr;
+	  std::rethrow_exception(e);
+	}
+  }
+};
+
+} // namespace tinystl
+
+#endif //TINYSTL__THREAD_POOL_H_
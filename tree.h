@@ -7,6 +7,9 @@
 
 /* <tree.h> 实现了 RB-tree（红黑树） */
 
+#include <functional>
+#include <type_traits>
+
 #include "memory.h"
 
 namespace tinystl {
@@ -40,6 +43,96 @@ struct _rb_tree_node : public _rb_tree_node_base {
   Value value_filed;
 }; // tree node end
 
+/* 节点增强（augmentation）
+ * rb_tree 的最后一个模板参数 Augment 为增强策略，使每个节点额外保存一份由其子树决定的数据 augment，
+ * 例如子树的大小（rb_tree_size_augment），借此可以在 O(log n) 内回答依赖子树信息的查询。策略需提供：
+ *   data_type                                             每个节点额外保存的数据
+ *   template<typename Node> static void update(Node *x)   由 x 自身的值与左右孩子（可能为空）的 augment 重新计算 x->augment
+ * 插入、删除、旋转与 join 改变某个节点的子树时，rb_tree 会自下而上对受影响的节点调用 update。
+ * 缺省的 rb_tree_no_augment 不保存任何数据，节点布局与调整过程都与未增强时相同 */
+struct rb_tree_no_augment {};
+
+template<typename Value, typename Data>
+struct _rb_tree_augmented_node : public _rb_tree_node<Value> {
+  Data augment;
+};
+
+template<typename Value, typename Augment>
+struct rb_tree_node_type {
+  using type = _rb_tree_augmented_node<Value, typename Augment::data_type>;
+};
+template<typename Value>
+struct rb_tree_node_type<Value, rb_tree_no_augment> {
+  using type = _rb_tree_node<Value>;
+};
+
+template<typename Value>
+inline void rb_tree_copy_augment(_rb_tree_node<Value> *, const _rb_tree_node<Value> *) {}
+template<typename Value, typename Data>
+inline void rb_tree_copy_augment(_rb_tree_augmented_node<Value, Data> *dst,
+								 const _rb_tree_augmented_node<Value, Data> *src) {
+  dst->augment = src->augment;
+}
+
+/* 以下的旋转、调整与 join 函数只接触 _rb_tree_node_base，通过 Update 回调重新计算节点的 augment */
+struct rb_tree_no_update {
+  void operator()(_rb_tree_node_base *) const {}
+};
+template<typename Node, typename Augment>
+struct rb_tree_augment_update {
+  void operator()(_rb_tree_node_base *x) const { Augment::update(static_cast<Node *>(x)); }
+};
+
+template<typename Node, typename Augment>
+struct rb_tree_update_type {
+  using type = rb_tree_augment_update<Node, Augment>;
+};
+template<typename Node>
+struct rb_tree_update_type<Node, rb_tree_no_augment> {
+  using type = rb_tree_no_update;
+};
+
+/* 不需要重新计算时，沿路径向上的遍历可以整个省去 */
+template<typename Update>
+constexpr bool rb_tree_is_updating() { return !std::is_same<Update, rb_tree_no_update>::value; }
+
+/* 子树的大小，用于 select/rank 等顺序统计（order statistic）查询 */
+struct rb_tree_size_augment {
+  using data_type = size_t;
+
+  template<typename Node>
+  static size_t size(const _rb_tree_node_base *x) { return x ? static_cast<const Node *>(x)->augment : 0; }
+  template<typename Node>
+  static void update(Node *x) { x->augment = 1 + size<Node>(x->left) + size<Node>(x->right); }
+};
+
+/* 用户自定义的汇总（summary），用于区间树、区间求和等，Summary 需提供：
+ *   summary_type                                         汇总值的类型
+ *   static summary_type identity()                       空序列的汇总
+ *   static summary_type make(const value_type &v)        单个元素的汇总
+ *   static summary_type combine(const summary_type &a, const summary_type &b)
+ *                                                        相邻两段（a 在前）的汇总，需满足结合律
+ * 每个节点保存其子树中全部元素按中序的汇总，rb_tree::aggregate 由此在 O(log n) 内求得键值区间内元素的汇总 */
+template<typename Summary>
+struct rb_tree_summary_augment {
+  using data_type = typename Summary::summary_type;
+
+  static data_type identity() { return Summary::identity(); }
+  template<typename Value>
+  static data_type make(const Value &v) { return Summary::make(v); }
+  static data_type combine(const data_type &a, const data_type &b) { return Summary::combine(a, b); }
+
+  template<typename Node>
+  static data_type summary(const _rb_tree_node_base *x) {
+	return x ? static_cast<const Node *>(x)->augment : Summary::identity();
+  }
+  template<typename Node>
+  static void update(Node *x) {
+	x->augment = Summary::combine(Summary::combine(summary<Node>(x->left), Summary::make(x->value_filed)),
+								  summary<Node>(x->right));
+  }
+};
+
 struct rb_tree_iterator_base {
   using base_ptr = _rb_tree_node_base::base_ptr;
   using iterator_category = bidirectional_iterator_tag;
@@ -126,7 +219,8 @@ struct rb_tree_iterator : public rb_tree_iterator_base {
 };
 
 /* 左旋操作 */
-inline void rb_tree_rotate_left(_rb_tree_node_base *x, _rb_tree_node_base *&root) {
+template<typename Update = rb_tree_no_update>
+inline void rb_tree_rotate_left(_rb_tree_node_base *x, _rb_tree_node_base *&root, Update update = Update()) {
   _rb_tree_node_base *y = x->right;
   x->right = y->left;
   if (y->left != nullptr) y->left->parent = x;
@@ -137,10 +231,13 @@ inline void rb_tree_rotate_left(_rb_tree_node_base *x, _rb_tree_node_base *&root
   else x->parent->right = y;
   y->left = x;
   x->parent = y;
+  update(x);
+  update(y);
 }
 
 /* 右旋操作 */
-inline void rb_tree_rotate_right(_rb_tree_node_base *x, _rb_tree_node_base *&root) {
+template<typename Update = rb_tree_no_update>
+inline void rb_tree_rotate_right(_rb_tree_node_base *x, _rb_tree_node_base *&root, Update update = Update()) {
   _rb_tree_node_base *y = x->left;
   x->left = y->right;
   if (y->right != nullptr) y->right->parent = x;
@@ -151,10 +248,13 @@ inline void rb_tree_rotate_right(_rb_tree_node_base *x, _rb_tree_node_base *&roo
   else x->parent->left = y;
   y->right = x;
   x->parent = y;
+  update(x);
+  update(y);
 }
 
 /* 调整 RB-tree */
-inline void rb_tree_rebalance(_rb_tree_node_base *x, _rb_tree_node_base *&root) {
+template<typename Update = rb_tree_no_update>
+inline void rb_tree_rebalance(_rb_tree_node_base *x, _rb_tree_node_base *&root, Update update = Update()) {
   x->color = rb_tree_red;
   while (x != root && x->parent->color == rb_tree_red) {
 	if (x->parent == x->parent->parent->left) {
@@ -167,11 +267,11 @@ inline void rb_tree_rebalance(_rb_tree_node_base *x, _rb_tree_node_base *&root)
 	  } else {
 		if (x == x->parent->right) {
 		  x = x->parent;
-		  rb_tree_rotate_left(x, root);
+		  rb_tree_rotate_left(x, root, update);
 		}
 		x->parent->color = rb_tree_black;
 		x->parent->parent->color = rb_tree_red;
-		rb_tree_rotate_right(x->parent->parent, root);
+		rb_tree_rotate_right(x->parent->parent, root, update);
 	  }
 	} else {
 	  _rb_tree_node_base *y = x->parent->parent->left;
@@ -183,22 +283,24 @@ inline void rb_tree_rebalance(_rb_tree_node_base *x, _rb_tree_node_base *&root)
 	  } else {
 		if (x == x->parent->left) {
 		  x = x->parent;
-		  rb_tree_rotate_right(x, root);
+		  rb_tree_rotate_right(x, root, update);
 		}
 		x->parent->color = rb_tree_black;
 		x->parent->parent->color = rb_tree_red;
-		rb_tree_rotate_left(x->parent->parent, root);
+		rb_tree_rotate_left(x->parent->parent, root, update);
 	  }
 	}
   }
   root->color = rb_tree_black;
 }
 
+template<typename Update = rb_tree_no_update>
 inline _rb_tree_node_base *rb_tree_rebalance_for_erase(_rb_tree_node_base *z,
 													   _rb_tree_node_base *&root,
 													   _rb_tree_node_base *&leftmost,
-													   _rb_tree_node_base *&rightmost) {
-  _rb_tree_node_base *y = nullptr;
+													   _rb_tree_node_base *&rightmost,
+													   Update update = Update()) {
+  _rb_tree_node_base *y = z;
   _rb_tree_node_base *x = nullptr;
   _rb_tree_node_base *x_parent = nullptr;
   if (y->left == nullptr)        // z has at most one non-null child. y == z.
@@ -252,6 +354,12 @@ inline _rb_tree_node_base *rb_tree_rebalance_for_erase(_rb_tree_node_base *z,
 	  else  // x == z->left
 		rightmost = _rb_tree_node_base::maximum(x);
   }
+  // 自被删除的位置向上，各祖先节点的子树均已改变，在调整颜色与旋转之前先重新计算
+  if (rb_tree_is_updating<Update>() && root != nullptr && x_parent != root->parent) {
+	for (_rb_tree_node_base *p = x_parent; p != root; p = p->parent)
+	  update(p);
+	update(root);
+  }
   if (y->color != rb_tree_red) {
 	while (x != root && (x == nullptr || x->color == rb_tree_black))
 	  if (x == x_parent->left) {
@@ -259,7 +367,7 @@ inline _rb_tree_node_base *rb_tree_rebalance_for_erase(_rb_tree_node_base *z,
 		if (w->color == rb_tree_red) {
 		  w->color = rb_tree_black;
 		  x_parent->color = rb_tree_red;
-		  rb_tree_rotate_left(x_parent, root);
+		  rb_tree_rotate_left(x_parent, root, update);
 		  w = x_parent->right;
 		}
 		if ((w->left == nullptr || w->left->color == rb_tree_black) &&
@@ -272,14 +380,14 @@ inline _rb_tree_node_base *rb_tree_rebalance_for_erase(_rb_tree_node_base *z,
 			if (w->left)
 			  w->left->color = rb_tree_black;
 			w->color = rb_tree_red;
-			rb_tree_rotate_right(w, root);
+			rb_tree_rotate_right(w, root, update);
 			w = x_parent->right;
 		  }
 		  w->color = x_parent->color;
 		  x_parent->color = rb_tree_black;
 		  if (w->right)
 			w->right->color = rb_tree_black;
-		  rb_tree_rotate_left(x_parent, root);
+		  rb_tree_rotate_left(x_parent, root, update);
 		  break;
 		}
 	  } else {  // same as above, with right <-> left.
@@ -287,7 +395,7 @@ inline _rb_tree_node_base *rb_tree_rebalance_for_erase(_rb_tree_node_base *z,
 		if (w->color == rb_tree_red) {
 		  w->color = rb_tree_black;
 		  x_parent->color = rb_tree_red;
-		  rb_tree_rotate_right(x_parent, root);
+		  rb_tree_rotate_right(x_parent, root, update);
 		  w = x_parent->left;
 		}
 		if ((w->right == nullptr || w->right->color == rb_tree_black) &&
@@ -300,14 +408,14 @@ inline _rb_tree_node_base *rb_tree_rebalance_for_erase(_rb_tree_node_base *z,
 			if (w->right)
 			  w->right->color = rb_tree_black;
 			w->color = rb_tree_red;
-			rb_tree_rotate_left(w, root);
+			rb_tree_rotate_left(w, root, update);
 			w = x_parent->left;
 		  }
 		  w->color = x_parent->color;
 		  x_parent->color = rb_tree_black;
 		  if (w->left)
 			w->left->color = rb_tree_black;
-		  rb_tree_rotate_right(x_parent, root);
+		  rb_tree_rotate_right(x_parent, root, update);
 		  break;
 		}
 	  }
@@ -317,12 +425,259 @@ inline _rb_tree_node_base *rb_tree_rebalance_for_erase(_rb_tree_node_base *z,
   return y;
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare = std::less<Key>, typename Allocator = Alloc>
+/********************************************************************************************************************/
+
+/* 以下为 join-based 集合操作所用的基础函数（Blelloch, Ferizovic, Sun, Just Join for Parallel Ordered Sets）
+ * 操作的对象是从树中摘下的子树，根节点总是黑色，并记录其黑高 black_height（根到任一空节点路径上黑色节点的个数），
+ * 这样 join 只需沿较高一侧的边走 |hl - hr| 步，无需重新计算黑高 */
+struct rb_tree_subtree {
+  _rb_tree_node_base *root;
+  int black_height;
+};
+
+/* 沿最左侧的路径计算以 x 为根的子树的黑高 */
+inline int rb_tree_black_height(_rb_tree_node_base *x) {
+  int h = 0;
+  for (; x != nullptr; x = x->left)
+	if (x->color == rb_tree_black) ++h;
+  return h;
+}
+
+/* 将 t 的根节点的孩子 c 摘下为一棵独立的子树，红色的根节点被染黑，黑高随之加一 */
+inline rb_tree_subtree rb_tree_child(const rb_tree_subtree &t, _rb_tree_node_base *c) {
+  int h = t.black_height - (t.root->color == rb_tree_black ? 1 : 0);
+  if (c != nullptr) {
+	c->parent = nullptr;
+	if (c->color == rb_tree_red) {
+	  c->color = rb_tree_black;
+	  ++h;
+	}
+  }
+  return rb_tree_subtree{c, h};
+}
+
+/* l 比 r 高：沿 l 的右侧边找到黑高与 r 相同的黑色节点 c，以红色的 x 代替 c，c 与 r 成为 x 的左右子树，
+ * 黑高保持不变，只可能在 x 与其父节点之间出现连续的红色，再沿右侧边向上调整 */
+template<typename Update>
+inline rb_tree_subtree rb_tree_join_right(rb_tree_subtree l, _rb_tree_node_base *x, rb_tree_subtree r, Update update) {
+  _rb_tree_node_base *root = l.root;
+  _rb_tree_node_base *p = nullptr;
+  _rb_tree_node_base *c = l.root;
+  int h = l.black_height;
+  while (c != nullptr && !(c->color == rb_tree_black && h == r.black_height)) {
+	if (c->color == rb_tree_black) --h;
+	p = c;
+	c = c->right;
+  }
+  x->left = c;
+  if (c) c->parent = x;
+  x->right = r.root;
+  if (r.root) r.root->parent = x;
+  x->parent = p;
+  p->right = x;
+  x->color = rb_tree_red;
+  _rb_tree_node_base *joined = x;
+  while (x != root && x->parent->color == rb_tree_red) {
+	_rb_tree_node_base *g = x->parent->parent; // 父节点为红色，不是根节点，因此 g 存在
+	_rb_tree_node_base *u = g->left;
+	if (u && u->color == rb_tree_red) {
+	  x->parent->color = rb_tree_black;
+	  u->color = rb_tree_black;
+	  g->color = rb_tree_red;
+	  x = g;
+	} else {
+	  x->parent->color = rb_tree_black;
+	  g->color = rb_tree_red;
+	  rb_tree_rotate_left(g, root, update);
+	  break;
+	}
+  }
+  // joined 及其各祖先节点的子树都已改变，旋转只重新计算了被旋转的两个节点
+  if (rb_tree_is_updating<Update>()) {
+	for (x = joined; x != root; x = x->parent)
+	  update(x);
+	update(root);
+  }
+  int black_height = l.black_height;
+  if (root->color == rb_tree_red) {
+	root->color = rb_tree_black;
+	++black_height;
+  }
+  return rb_tree_subtree{root, black_height};
+}
+
+/* 与 rb_tree_join_right 对称，r 比 l 高 */
+template<typename Update>
+inline rb_tree_subtree rb_tree_join_left(rb_tree_subtree l, _rb_tree_node_base *x, rb_tree_subtree r, Update update) {
+  _rb_tree_node_base *root = r.root;
+  _rb_tree_node_base *p = nullptr;
+  _rb_tree_node_base *c = r.root;
+  int h = r.black_height;
+  while (c != nullptr && !(c->color == rb_tree_black && h == l.black_height)) {
+	if (c->color == rb_tree_black) --h;
+	p = c;
+	c = c->left;
+  }
+  x->right = c;
+  if (c) c->parent = x;
+  x->left = l.root;
+  if (l.root) l.root->parent = x;
+  x->parent = p;
+  p->left = x;
+  x->color = rb_tree_red;
+  _rb_tree_node_base *joined = x;
+  while (x != root && x->parent->color == rb_tree_red) {
+	_rb_tree_node_base *g = x->parent->parent;
+	_rb_tree_node_base *u = g->right;
+	if (u && u->color == rb_tree_red) {
+	  x->parent->color = rb_tree_black;
+	  u->color = rb_tree_black;
+	  g->color = rb_tree_red;
+	  x = g;
+	} else {
+	  x->parent->color = rb_tree_black;
+	  g->color = rb_tree_red;
+	  rb_tree_rotate_right(g, root, update);
+	  break;
+	}
+  }
+  // joined 及其各祖先节点的子树都已改变，旋转只重新计算了被旋转的两个节点
+  if (rb_tree_is_updating<Update>()) {
+	for (x = joined; x != root; x = x->parent)
+	  update(x);
+	update(root);
+  }
+  int black_height = r.black_height;
+  if (root->color == rb_tree_red) {
+	root->color = rb_tree_black;
+	++black_height;
+  }
+  return rb_tree_subtree{root, black_height};
+}
+
+/* 以节点 x 连接 l 与 r，要求 l 中的键值均不大于 x，r 中的键值均不小于 x */
+template<typename Update>
+inline rb_tree_subtree rb_tree_join(rb_tree_subtree l, _rb_tree_node_base *x, rb_tree_subtree r, Update update) {
+  if (l.black_height > r.black_height)
+	return rb_tree_join_right(l, x, r, update);
+  if (l.black_height < r.black_height)
+	return rb_tree_join_left(l, x, r, update);
+  x->left = l.root;
+  if (l.root) l.root->parent = x;
+  x->right = r.root;
+  if (r.root) r.root->parent = x;
+  x->parent = nullptr;
+  x->color = rb_tree_black;
+  update(x);
+  return rb_tree_subtree{x, l.black_height + 1};
+}
+
+/* 摘下 t 中最右侧的节点 m，其余节点组成 rest */
+template<typename Update>
+inline void rb_tree_split_last(rb_tree_subtree t, rb_tree_subtree &rest, _rb_tree_node_base *&m, Update update) {
+  _rb_tree_node_base *x = t.root;
+  rb_tree_subtree l = rb_tree_child(t, x->left);
+  if (x->right == nullptr) {
+	m = x;
+	rest = l;
+	return;
+  }
+  rb_tree_subtree r;
+  rb_tree_split_last(rb_tree_child(t, x->right), r, m, update);
+  rest = rb_tree_join(l, x, r, update);
+}
+
+/* 连接 l 与 r，要求 l 中的键值均不大于 r 中的键值 */
+template<typename Update>
+inline rb_tree_subtree rb_tree_join2(rb_tree_subtree l, rb_tree_subtree r, Update update) {
+  if (l.root == nullptr) return r;
+  if (r.root == nullptr) return l;
+  rb_tree_subtree rest;
+  _rb_tree_node_base *m;
+  rb_tree_split_last(l, rest, m, update);
+  return rb_tree_join(rest, m, r, update);
+}
+
+/* join-based 集合运算中两个递归分支的执行方式
+ * fork(left, right) 执行两个分支，两者都完成后返回；fork.child() 返回下一层递归所用的 Fork。
+ * rb_tree_serial_fork 依次执行两个分支，以线程池并行执行的版本参见 <parallel_tree.h> */
+struct rb_tree_serial_fork {
+  template<typename LeftTask, typename RightTask>
+  void operator()(LeftTask left, RightTask right) const {
+	left();
+	right();
+  }
+  rb_tree_serial_fork child() const { return *this; }
+};
+
+/* 节点句柄（node handle），持有一个已从树中摘下的节点，由 extract 返回，可再由 insert 链入同类型的树
+ * 节点在树之间移动时既不重新配置也不复制元素。句柄只能移动，析构时销毁其持有的节点 */
+template<typename Value, typename Node, typename NodeAllocator>
+class rb_tree_node_handle {
+  template<typename, typename, typename, typename, typename, typename> friend class rb_tree;
+
+ public:
+  using value_type = Value;
+
+  rb_tree_node_handle() noexcept : node(nullptr) {}
+  rb_tree_node_handle(rb_tree_node_handle &&rhs) noexcept : node(rhs.node) { rhs.node = nullptr; }
+  rb_tree_node_handle &operator=(rb_tree_node_handle &&rhs) noexcept {
+	if (this != &rhs) {
+	  reset();
+	  node = rhs.node;
+	  rhs.node = nullptr;
+	}
+	return *this;
+  }
+  rb_tree_node_handle(const rb_tree_node_handle &) = delete;
+  rb_tree_node_handle &operator=(const rb_tree_node_handle &) = delete;
+  ~rb_tree_node_handle() { reset(); }
+
+  bool empty() const noexcept { return node == nullptr; }
+  explicit operator bool() const noexcept { return node != nullptr; }
+  value_type &value() const { return node->value_filed; }
+  void swap(rb_tree_node_handle &rhs) noexcept { std::swap(node, rhs.node); }
+
+ private:
+  explicit rb_tree_node_handle(Node *x) noexcept : node(x) {}
+  Node *release() noexcept {
+	Node *x = node;
+	node = nullptr;
+	return x;
+  }
+  void reset() {
+	if (node) {
+	  destroy(&node->value_filed);
+	  NodeAllocator::deallocate(node);
+	  node = nullptr;
+	}
+  }
+
+  Node *node;
+};
+
+template<typename Value, typename Node, typename NodeAllocator>
+inline void swap(rb_tree_node_handle<Value, Node, NodeAllocator> &lhs,
+				 rb_tree_node_handle<Value, Node, NodeAllocator> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+/* 以节点句柄 insert 的结果：inserted 为 false 时 position 指向键值相同的已有元素，节点仍由 node 持有 */
+template<typename Iterator, typename NodeHandle>
+struct rb_tree_insert_return {
+  Iterator position;
+  bool inserted;
+  NodeHandle node;
+};
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare = std::less<Key>, typename Allocator = Alloc,
+		 typename Augment = rb_tree_no_augment>
 class rb_tree {
  protected:
   using void_pointer = void *;
   using base_ptr = _rb_tree_node_base *;
-  using rb_tree_node = _rb_tree_node<Value>;
+  using rb_tree_node = typename rb_tree_node_type<Value, Augment>::type;
+  using node_update = typename rb_tree_update_type<rb_tree_node, Augment>::type;
   using rb_tree_node_allocator = alloc<rb_tree_node, Alloc>;
   using color_type = rb_tree_color_type;
 
@@ -332,7 +687,7 @@ class rb_tree {
   using pointer = value_type *;
   using const_pointer = const value_type *;
   using reference = value_type &;
-  using const_reference = value_type &;
+  using const_reference = const value_type &;
   using link_type = rb_tree_node *;
   using size_type = size_t;
   using difference_type = ptrdiff_t;
@@ -341,6 +696,8 @@ class rb_tree {
   using const_iterator = rb_tree_iterator<value_type, const_reference, const_pointer>;
   using reverse_iterator = tinystl::reverse_iterator<iterator>;
   using const_reverse_iterator = tinystl::reverse_iterator<const_iterator>;
+  using node_type = rb_tree_node_handle<value_type, rb_tree_node, rb_tree_node_allocator>;
+  using insert_return_type = rb_tree_insert_return<iterator, node_type>;
 
  protected:
   size_type node_count{};
@@ -366,6 +723,7 @@ class rb_tree {
   }
   link_type clone_node(link_type x) {
 	link_type tmp = create_node(x->value_filed);
+	rb_tree_copy_augment(tmp, x);
 	tmp->color = x->color;
 	tmp->left = nullptr;
 	tmp->right = nullptr;
@@ -382,12 +740,31 @@ class rb_tree {
   static reference value(link_type x) { return x->value_filed; }
   static const Key &key(link_type x) { return KeyOfValue()(value(x)); }
   static color_type &color(link_type x) { return static_cast<color_type &>(x->color); }
+  static reference value(base_ptr x) { return static_cast<link_type>(x)->value_filed; }
+  static const Key &key(base_ptr x) { return KeyOfValue()(value(x)); }
 
   static link_type minimum(link_type x) { return (link_type)(_rb_tree_node_base::minimum(x)); }
   static link_type maximum(link_type x) { return (link_type)(_rb_tree_node_base::maximum(x)); }
+  static size_type subtree_size(base_ptr x) { return Augment::template size<rb_tree_node>(x); }
 
  private:
-  iterator insert_aux(base_ptr x, base_ptr y, const value_type &v);
+  iterator insert_aux(base_ptr x, base_ptr y, const value_type &v) { return link_aux(x, y, create_node(v)); }
+  iterator link_aux(base_ptr x, base_ptr y, link_type z);
+  std::pair<base_ptr, bool> insert_unique_pos(const key_type &k);
+  base_ptr insert_equal_pos(const key_type &k);
+  link_type select_aux(size_type n) const;
+  template<typename It, typename Enter, typename Stop, typename Visit>
+  static bool search_aux(base_ptr x, Enter &enter, Stop &stop, Visit &visit) {
+	// 右子树以循环代替递归
+	while (x != nullptr && enter(static_cast<link_type>(x)->augment)) {
+	  if (!search_aux<It>(x->left, enter, stop, visit))
+		return false;
+	  if (stop(value(x)) || !visit(It(static_cast<link_type>(x))))
+		return false;
+	  x = x->right;
+	}
+	return true;
+  }
   link_type copy_aux(link_type x, link_type p) {
 	link_type top = clone_node(x);
 	top->parent = p;
@@ -412,7 +789,47 @@ class rb_tree {
 	}
 	return top;
   }
-  void erase_aux(link_type x);
+  size_type erase_aux(link_type x);
+  template<typename ForwardIterator>
+  bool sorted_count(ForwardIterator first, ForwardIterator last, bool unique, size_type &n) const;
+  template<typename ForwardIterator>
+  link_type build_sorted_aux(ForwardIterator &first, ForwardIterator last, size_type n,
+							 size_type depth, size_type red_depth, bool unique);
+  template<typename ForwardIterator>
+  void build_sorted(ForwardIterator first, ForwardIterator last, size_type n, bool unique);
+  template<typename InputIterator>
+  void insert_unique(InputIterator first, InputIterator last, input_iterator_tag);
+  template<typename ForwardIterator>
+  void insert_unique(ForwardIterator first, ForwardIterator last, forward_iterator_tag);
+  template<typename InputIterator>
+  void insert_equal(InputIterator first, InputIterator last, input_iterator_tag);
+  template<typename ForwardIterator>
+  void insert_equal(ForwardIterator first, ForwardIterator last, forward_iterator_tag);
+
+  /* join-based 集合操作的辅助函数
+   * 集合运算中被舍弃的子树先以根节点的 parent 指针串成链表，待运算结束后再由当前线程统一归还，
+   * 因此并行执行的部分只会重新链接节点，不会调用非线程安全的配置器 */
+  enum set_operation_type { op_union_unique, op_union_equal, op_intersection, op_difference };
+  struct discard_list {
+	base_ptr head = nullptr;
+	base_ptr tail = nullptr;
+  };
+  static void discard(discard_list &d, rb_tree_subtree t);
+  static void splice(discard_list &d, discard_list &rhs);
+  size_type destroy_discarded(discard_list &d);
+  rb_tree_subtree take_subtree();
+  void put_subtree(rb_tree_subtree t, size_type n);
+  void split_aux(rb_tree_subtree t, const key_type &k,
+				 rb_tree_subtree &less, rb_tree_subtree &equal, rb_tree_subtree &greater) const;
+  template<typename Fork>
+  rb_tree_subtree union_aux(rb_tree_subtree t1, rb_tree_subtree t2, bool unique, Fork fork, discard_list &d) const;
+  template<typename Fork>
+  rb_tree_subtree intersection_aux(rb_tree_subtree t1, rb_tree_subtree t2, Fork fork, discard_list &d) const;
+  template<typename Fork>
+  rb_tree_subtree difference_aux(rb_tree_subtree t1, rb_tree_subtree t2, Fork fork, discard_list &d) const;
+  template<typename Fork>
+  void set_operation(rb_tree &other, set_operation_type op, Fork fork);
+
   void init() {
 	header = get_node();
 	color(header) = rb_tree_red;
@@ -442,7 +859,7 @@ class rb_tree {
 		throw;
 	  }
 	  leftmost() = minimum(root());
-	  rightmost() = maximun(root());
+	  rightmost() = maximum(root());
 	}
 	node_count = rhs.node_count;
 	key_compare = rhs.key_compare;
@@ -480,6 +897,11 @@ class rb_tree {
   bool empty() const noexcept { return node_count == 0; }
   size_type size() const noexcept { return node_count; }
   size_type max_size() const noexcept { return static_cast<size_type>(-1); }
+  void swap(rb_tree &rhs) noexcept {
+	std::swap(header, rhs.header);
+	std::swap(node_count, rhs.node_count);
+	std::swap(key_compare, rhs.key_compare);
+  }
 
   /* container 相关操作 */
   std::pair<iterator, bool> insert_unique(const value_type &value);
@@ -487,10 +909,56 @@ class rb_tree {
   iterator insert_unique(iterator position, const value_type &value);
   iterator insert_equal(iterator position, const value_type &value);
 
+  /* 区间插入：树为空且区间已排序时（常见于快照、范围扫描的结果），以 O(n) 直接建立平衡的树，
+   * 否则逐个插入。insert_unique 允许区间中含有重复的键值，只保留其中的第一个 */
   template<typename InputIterator>
-  void insert_unique(InputIterator first, InputIterator last);
+  void insert_unique(InputIterator first, InputIterator last) {
+	insert_unique(first, last, iterator_category(first));
+  }
   template<typename InputIterator>
-  void insert_equal(InputIterator first, InputIterator last);
+  void insert_equal(InputIterator first, InputIterator last) {
+	insert_equal(first, last, iterator_category(first));
+  }
+
+  /* 追加有序的区间，如按时间戳递增到达的一批数据：先以 O(k) 将区间建成一棵平衡的树（参见区间版本的 insert），
+   * 区间中的键值均大于（append_sorted_equal 为不小于）树中的最大键值时，再以 join 沿右侧的脊在 O(log n) 内接入，共 O(k + log n)；
+   * 否则退化为 union_unique/union_equal。区间无序时仍然正确，只是建树时逐个插入 */
+  template<typename InputIterator>
+  void append_sorted_unique(InputIterator first, InputIterator last) {
+	rb_tree tail(key_compare);
+	tail.insert_unique(first, last);
+	if (empty() || (!tail.empty() && key_compare(key(rightmost()), key(tail.leftmost()))))
+	  join(tail);
+	else
+	  union_unique(tail);
+  }
+  template<typename InputIterator>
+  void append_sorted_equal(InputIterator first, InputIterator last) {
+	rb_tree tail(key_compare);
+	tail.insert_equal(first, last);
+	if (empty() || (!tail.empty() && !key_compare(key(tail.leftmost()), key(rightmost()))))
+	  join(tail);
+	else
+	  union_equal(tail);
+  }
+
+  /* 节点句柄相关操作，节点只会被摘下或重新链接，不经过配置器，也不复制元素
+   * extract 摘下 position 所指的节点或第一个键值为 x 的节点，不存在时返回空的句柄
+   * insert_unique/insert_equal 将句柄持有的节点链入树中，insert_unique 遇到重复的键值时节点仍留在返回值的 node 中
+   * merge_unique 将 source 中键值在 *this 中不存在的节点移入 *this，其余的留在 source 中，O(m log(n + m))；
+   * merge_equal 以 union_equal 移入 source 的全部节点，键值相同的元素之间的次序不作保证 */
+  node_type extract(iterator position);
+  node_type extract(const key_type &x) {
+	iterator it = find(x);
+	return it == end() ? node_type() : extract(it);
+  }
+  insert_return_type insert_unique(node_type &&nh);
+  iterator insert_equal(node_type &&nh);
+  void merge_unique(rb_tree &source);
+  void merge_equal(rb_tree &source) {
+	if (&source != this)
+	  union_equal(source);
+  }
 
   void erase(iterator position);
   size_type erase(const key_type &x);
@@ -506,6 +974,28 @@ class rb_tree {
 	}
   }
 
+  /* join-based 集合操作
+   * split 将键值不小于 k 的元素移入 right（right 原有的元素被清除），*this 保留键值小于 k 的元素；
+   * join 将 right 的全部元素移入 *this，要求 *this 中的键值均不大于 right 中的键值。
+   * union_unique/union_equal、intersection、difference 以 *this 与 other 的运算结果取代 *this 的内容，other 被清空：
+   *   union_unique   键值相同时保留 *this 中的元素
+   *   union_equal    保留两者的全部元素
+   *   intersection   保留 *this 中键值在 other 中出现的元素
+   *   difference     保留 *this 中键值未在 other 中出现的元素
+   * 节点只会被重新链接或归还，不会重新配置与复制元素。split/join 为 O(log n)（split 另需 O(min(|left|, |right|)) 计数），
+   * 集合运算为 O(m log(n / m + 1))，m <= n 为两者的大小。运算过程中 Compare 不得抛出异常。
+   * 集合运算的两个递归分支缺省依次执行，传入 Fork 可改变其执行方式，如 <parallel_tree.h> 以线程池并行执行 */
+  void split(const key_type &k, rb_tree &right);
+  void join(rb_tree &right);
+  template<typename Fork = rb_tree_serial_fork>
+  void union_unique(rb_tree &other, Fork fork = Fork()) { set_operation(other, op_union_unique, fork); }
+  template<typename Fork = rb_tree_serial_fork>
+  void union_equal(rb_tree &other, Fork fork = Fork()) { set_operation(other, op_union_equal, fork); }
+  template<typename Fork = rb_tree_serial_fork>
+  void intersection(rb_tree &other, Fork fork = Fork()) { set_operation(other, op_intersection, fork); }
+  template<typename Fork = rb_tree_serial_fork>
+  void difference(rb_tree &other, Fork fork = Fork()) { set_operation(other, op_difference, fork); }
+
   iterator find(const key_type &k);
   const_iterator find(const key_type &k) const;
   size_type count(const key_type &k) const;
@@ -515,31 +1005,74 @@ class rb_tree {
   const_iterator upper_bound(const key_type &k) const;
   std::pair<iterator, iterator> equal_range(const key_type &k);
   std::pair<const_iterator, const_iterator> equal_range(const key_type &k) const;
-  int black_count(base_ptr node, base_ptr root);
+
+  /* 顺序统计（order statistic），要求 Augment 提供子树大小 size（如 rb_tree_size_augment），均为 O(log n)
+   * select(n) 返回中序第 n 个（从 0 开始）元素，n >= size() 时返回 end()
+   * rank(k) 返回键值小于 k 的元素个数，即 lower_bound(k) 的下标
+   * index_of(it) 返回 it 的下标，it 为 end() 时返回 size()
+   * distance(first, last) 即 index_of(last) - index_of(first)，不必逐个遍历 */
+  iterator select(size_type n) { return iterator(select_aux(n)); }
+  const_iterator select(size_type n) const { return const_iterator(select_aux(n)); }
+  size_type rank(const key_type &k) const;
+  size_type index_of(const_iterator position) const;
+  difference_type distance(const_iterator first, const_iterator last) const {
+	return static_cast<difference_type>(index_of(last)) - static_cast<difference_type>(index_of(first));
+  }
+
+  /* 汇总查询，要求 Augment 提供 identity/make/combine/summary（如 rb_tree_summary_augment）
+   * aggregate() 为全部元素的汇总，aggregate(lo, hi) 为键值在 [lo, hi) 内的元素的汇总，O(log n) */
+  template<typename A = Augment>
+  typename A::data_type aggregate() const {
+	static_assert(std::is_same<A, Augment>::value, "aggregate uses the tree's own augment");
+	return A::template summary<rb_tree_node>(header->parent);
+  }
+  template<typename A = Augment>
+  typename A::data_type aggregate(const key_type &lo, const key_type &hi) const;
+
+  /* 以子树的 augment 剪枝的中序遍历，用于区间树等查询，O(log n + k)，k 为被访问的元素个数
+   * enter(augment)：子树中是否可能含有目标元素，为 false 时跳过整棵子树
+   * stop(value)：该元素及中序在其后的元素是否均不可能是目标，为 true 时结束遍历
+   * visit(iterator)：依次访问其余的元素，返回 false 时结束遍历 */
+  template<typename Enter, typename Stop, typename Visit>
+  void search(Enter enter, Stop stop, Visit visit) {
+	search_aux<iterator>(header->parent, enter, stop, visit);
+  }
+  template<typename Enter, typename Stop, typename Visit>
+  void search(Enter enter, Stop stop, Visit visit) const {
+	search_aux<const_iterator>(header->parent, enter, stop, visit);
+  }
+
+  /* 就地修改了 position 所指元素中参与 augment 计算的部分（如 map 的实值）后，沿路径向上重新计算 augment */
+  void refresh(iterator position) {
+	for (base_ptr p = position.node; p != header; p = p->parent)
+	  node_update()(p);
+  }
+
+  static int black_count(base_ptr node, base_ptr root);
   bool rb_verify() const;
 }; // class rb_tree end
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-inline bool operator==(const rb_tree<Key, Value, KeyOfValue, Compare, Allocator> &lhs,
-					   const rb_tree<Key, Value, KeyOfValue, Compare, Allocator> &rhs) {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+inline bool operator==(const rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment> &lhs,
+					   const rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment> &rhs) {
   return lhs.size() == rhs.size() && equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-inline bool operator<(const rb_tree<Key, Value, KeyOfValue, Compare, Allocator> &lhs,
-					  const rb_tree<Key, Value, KeyOfValue, Compare, Allocator> &rhs) {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+inline bool operator<(const rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment> &lhs,
+					  const rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment> &rhs) {
   return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-inline void swap(rb_tree<Key, Value, KeyOfValue, Compare, Allocator> &lhs,
-				 rb_tree<Key, Value, KeyOfValue, Compare, Allocator> &rhs) {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+inline void swap(rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment> &lhs,
+				 rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment> &rhs) {
   lhs.swap(rhs);
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator> &
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::operator=(const rb_tree &rhs) {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment> &
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::operator=(const rb_tree &rhs) {
   if (this != &rhs) {
 	clear();
 	node_count = 0;
@@ -558,9 +1091,9 @@ rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::operator=(const rb_tree &rh
   return *this;
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator> &
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment> &
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::
 operator=(rb_tree &&rhs) noexcept {
   clear();
   header = std::move(rhs.header);
@@ -570,16 +1103,12 @@ operator=(rb_tree &&rhs) noexcept {
   return *this;
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::iterator
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::insert_aux(base_ptr x_,
-																base_ptr y_,
-																const Value &v) {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::link_aux(base_ptr x_, base_ptr y_, link_type z) {
   link_type x = static_cast<link_type>(x_);
   link_type y = static_cast<link_type>(y_);
-  link_type z;
-  if (y == header || x != nullptr || key_compare(KeyOfValue()(v), key(y))) {
-	z = create_node(v);
+  if (y == header || x != nullptr || key_compare(key(z), key(y))) {
 	left(y) = z;
 	if (y == header) {
 	  root() = z;
@@ -587,7 +1116,6 @@ rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::insert_aux(base_ptr x_,
 	} else if (y == leftmost())
 	  leftmost() = z;
   } else {
-	z = create_node(v);
 	right(y) = z;
 	if (y == rightmost())
 	  rightmost() = z;
@@ -595,48 +1123,74 @@ rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::insert_aux(base_ptr x_,
   parent(z) = y;
   left(z) = 0;
   right(z) = 0;
-  rb_tree_rebalance(z, header->parent);
+  // 新节点的各祖先节点的子树都多了一个节点
+  if (rb_tree_is_updating<node_update>())
+	for (base_ptr p = z; p != header; p = p->parent)
+	  node_update()(p);
+  rb_tree_rebalance(z, header->parent, node_update());
   ++node_count;
   return iterator(z);
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::iterator
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::insert_equal(const Value &v) {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::base_ptr
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::insert_equal_pos(const Key &k) {
+  // 追加到最右侧时（如递增的时间戳）只需一次比较，不必自根向下查找
+  if (node_count != 0 && !key_compare(k, key(rightmost())))
+	return rightmost();
   link_type y = header;
   link_type x = root();
   while (x != 0) {
 	y = x;
-	x = key_compare(KeyOfValue()(v), key(x)) ? left(x) : right(x);
+	x = key_compare(k, key(x)) ? left(x) : right(x);
   }
-  return insert_aux(x, y, v);
+  return y;
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-std::pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::iterator, bool>
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::insert_unique(const Value &v) {
+/* 键值 k 不存在时返回 (新节点的父节点, true)，否则返回 (键值为 k 的节点, false) */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+std::pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::base_ptr, bool>
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::insert_unique_pos(const Key &k) {
+  // 追加到最右侧时（如递增的时间戳）只需一次比较，不必自根向下查找
+  if (node_count != 0 && key_compare(key(rightmost()), k))
+	return std::pair<base_ptr, bool>(rightmost(), true);
   link_type y = header;
   link_type x = root();
   bool comp = true;
   while (x != 0) {
 	y = x;
-	comp = key_compare(KeyOfValue()(v), key(x));
+	comp = key_compare(k, key(x));
 	x = comp ? left(x) : right(x);
   }
   iterator j = iterator(y);
   if (comp)
 	if (j == begin())
-	  return std::pair<iterator, bool>(insert_aux(x, y, v), true);
+	  return std::pair<base_ptr, bool>(y, true);
 	else
 	  --j;
-  if (key_compare(key(j.node), KeyOfValue()(v)))
-	return std::pair<iterator, bool>(insert_aux(x, y, v), true);
-  return std::pair<iterator, bool>(j, false);
+  if (key_compare(key(j.node), k))
+	return std::pair<base_ptr, bool>(y, true);
+  return std::pair<base_ptr, bool>(j.node, false);
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::insert_equal(const Value &v) {
+  return insert_aux(0, insert_equal_pos(KeyOfValue()(v)), v);
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+std::pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::iterator, bool>
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::insert_unique(const Value &v) {
+  std::pair<base_ptr, bool> p = insert_unique_pos(KeyOfValue()(v));
+  if (!p.second)
+	return std::pair<iterator, bool>(iterator(static_cast<link_type>(p.first)), false);
+  return std::pair<iterator, bool>(insert_aux(0, p.first, v), true);
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::iterator
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::insert_unique(iterator position,
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::insert_unique(iterator position,
 																   const Value &v) {
   link_type pos_node = static_cast<link_type>(position.node);
   if (pos_node == header->left)
@@ -650,9 +1204,10 @@ rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::insert_unique(iterator posi
 	else
 	  return insert_unique(v).first;
   else {
+	// v 应位于 position 的前驱 before 与 position 之间
 	iterator before = position;
-	link_type bef_node = static_cast<link_type>(before.node);
 	--before;
+	link_type bef_node = static_cast<link_type>(before.node);
 	if (key_compare(key(bef_node), KeyOfValue()(v)) &&
 		key_compare(KeyOfValue()(v), key(pos_node)))
 	  if (right(bef_node) == 0)
@@ -664,9 +1219,9 @@ rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::insert_unique(iterator posi
   }
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::iterator
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::insert_equal(iterator position,
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::insert_equal(iterator position,
 																  const Value &v) {
   link_type pos_node = static_cast<link_type>(position.node);
   if (pos_node == header->left)
@@ -681,8 +1236,8 @@ rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::insert_equal(iterator posit
 	  return insert_equal(v);
   else {
 	iterator before = position;
-	link_type bef_node = static_cast<link_type>(before.node);
 	--before;
+	link_type bef_node = static_cast<link_type>(before.node);
 	if (!key_compare(KeyOfValue()(v), key(bef_node)) &&
 		!key_compare(key(pos_node), KeyOfValue()(v)))
 	  if (right(bef_node) == 0)
@@ -695,52 +1250,195 @@ rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::insert_equal(iterator posit
   }
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-template<typename II>
-void rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::insert_equal(II first, II last) {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+template<typename InputIterator>
+void rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::insert_equal(InputIterator first, InputIterator last,
+																	   input_iterator_tag) {
   for (; first != last; ++first)
 	insert_equal(*first);
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-template<typename II>
-void rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::insert_unique(II first, II last) {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+template<typename ForwardIterator>
+void rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::insert_equal(ForwardIterator first, ForwardIterator last,
+																	   forward_iterator_tag) {
+  size_type n = 0;
+  if (empty() && sorted_count(first, last, false, n))
+	build_sorted(first, last, n, false);
+  else
+	insert_equal(first, last, input_iterator_tag());
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+template<typename InputIterator>
+void rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::insert_unique(InputIterator first, InputIterator last,
+																		input_iterator_tag) {
   for (; first != last; ++first)
 	insert_unique(*first);
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-inline void rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::erase(iterator position) {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+template<typename ForwardIterator>
+void rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::insert_unique(ForwardIterator first, ForwardIterator last,
+																		forward_iterator_tag) {
+  size_type n = 0;
+  if (empty() && sorted_count(first, last, true, n))
+	build_sorted(first, last, n, true);
+  else
+	insert_unique(first, last, input_iterator_tag());
+}
+
+/* 检查 [first, last) 是否按键值非递减排列，同时统计将被插入的元素个数 n（unique 时不计重复的键值） */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+template<typename ForwardIterator>
+bool rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::sorted_count(ForwardIterator first, ForwardIterator last,
+																	   bool unique, size_type &n) const {
+  n = 0;
+  if (first == last)
+	return true;
+  n = 1;
+  ForwardIterator prev = first;
+  for (++first; first != last; prev = first, ++first) {
+	if (key_compare(KeyOfValue()(*first), KeyOfValue()(*prev)))
+	  return false;
+	if (!unique || key_compare(KeyOfValue()(*prev), KeyOfValue()(*first)))
+	  ++n;
+  }
+  return true;
+}
+
+/* 以 first 起已排序的 n 个元素建立一棵子树，返回其根节点，first 前进到下一个未使用的元素
+ * 以中间的元素为根，左右子树的大小至多相差 1，这样的树中深度小于 red_depth 的各层都是满的：
+ * 将深度为 red_depth 的最后一层染为红色、其余各层染为黑色，即满足红黑树的全部性质，无需再做任何旋转 */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+template<typename ForwardIterator>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::link_type
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::build_sorted_aux(ForwardIterator &first, ForwardIterator last,
+																	  size_type n, size_type depth,
+																	  size_type red_depth, bool unique) {
+  if (n == 0)
+	return nullptr;
+  const size_type left_count = (n - 1) / 2;
+  link_type l = build_sorted_aux(first, last, left_count, depth + 1, red_depth, unique);
+  link_type x;
+  try {
+	x = create_node(*first);
+  } catch (...) {
+	if (l) erase_aux(l);
+	throw;
+  }
+  // unique 时跳过与刚插入的元素键值相同的元素
+  ForwardIterator prev = first;
+  for (++first; unique && first != last && !key_compare(KeyOfValue()(*prev), KeyOfValue()(*first)); ++first) {}
+  left(x) = l;
+  right(x) = nullptr;
+  if (l) parent(l) = x;
+  color(x) = depth == red_depth && depth != 0 ? rb_tree_red : rb_tree_black;
+  try {
+	right(x) = build_sorted_aux(first, last, n - 1 - left_count, depth + 1, red_depth, unique);
+  } catch (...) {
+	erase_aux(x);
+	throw;
+  }
+  if (right(x)) parent(right(x)) = x;
+  node_update()(x);
+  return x;
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+template<typename ForwardIterator>
+void rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::build_sorted(ForwardIterator first, ForwardIterator last,
+																	   size_type n, bool unique) {
+  if (n == 0)
+	return;
+  // 最后一层的深度为 floor(log2(n))
+  size_type red_depth = 0;
+  for (size_type m = n; m > 1; m >>= 1) ++red_depth;
+  root() = build_sorted_aux(first, last, n, 0, red_depth, unique);
+  parent(root()) = header;
+  leftmost() = minimum(root());
+  rightmost() = maximum(root());
+  node_count = n;
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::node_type
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::extract(iterator position) {
   link_type y = (link_type)rb_tree_rebalance_for_erase(
-	  position.node, header->parent, header->left, header->right);
+	  position.node, header->parent, header->left, header->right, node_update());
+  --node_count;
+  return node_type(y);
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::insert_return_type
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::insert_unique(node_type &&nh) {
+  if (nh.empty())
+	return insert_return_type{end(), false, node_type()};
+  std::pair<base_ptr, bool> p = insert_unique_pos(key(nh.node));
+  if (!p.second)
+	return insert_return_type{iterator(static_cast<link_type>(p.first)), false, std::move(nh)};
+  return insert_return_type{link_aux(0, p.first, nh.release()), true, node_type()};
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::insert_equal(node_type &&nh) {
+  if (nh.empty())
+	return end();
+  base_ptr y = insert_equal_pos(key(nh.node));
+  return link_aux(0, y, nh.release());
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+void rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::merge_unique(rb_tree &source) {
+  if (&source == this)
+	return;
+  for (iterator it = source.begin(); it != source.end();) {
+	iterator next = it;
+	++next;
+	std::pair<base_ptr, bool> p = insert_unique_pos(key(it.node));
+	if (p.second)
+	  link_aux(0, p.first, source.extract(it).release());
+	it = next;
+  }
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+inline void rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::erase(iterator position) {
+  link_type y = (link_type)rb_tree_rebalance_for_erase(
+	  position.node, header->parent, header->left, header->right, node_update());
   destroy_node(y);
   --node_count;
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::size_type
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::erase(const Key &x) {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::size_type
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::erase(const Key &x) {
   std::pair<iterator, iterator> p = equal_range(x);
   size_type n = 0;
-  distance(p.first, p.second, n);
+  tinystl::distance(p.first, p.second, n);
   erase(p.first, p.second);
   return n;
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-void rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::erase_aux(link_type
-x) {
-while (x != 0) {
-erase_aux(right(x)
-);
-link_type y = left(x);
-destroy_node(x);
-x = y;
-}
+/* 销毁以 x 为根的子树，返回销毁的节点个数 */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::size_type
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::erase_aux(link_type x) {
+  size_type n = 0;
+  while (x != 0) {
+	n += erase_aux(right(x));
+	link_type y = left(x);
+	destroy_node(x);
+	x = y;
+	++n;
+  }
+  return n;
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-void rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::erase(iterator first,
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+void rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::erase(iterator first,
 																iterator last) {
   if (first == begin() && last == end())
 	clear();
@@ -749,16 +1447,245 @@ void rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::erase(iterator first,
 	  erase(first++);
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-void rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::erase(const Key *first,
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+void rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::erase(const Key *first,
 																const Key *last) {
   while (first != last)
 	erase(*first++);
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::iterator
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::find(const Key &k) {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+void rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::discard(discard_list &d, rb_tree_subtree t) {
+  if (t.root == nullptr)
+	return;
+  t.root->parent = nullptr;
+  if (d.head == nullptr)
+	d.head = t.root;
+  else
+	d.tail->parent = t.root;
+  d.tail = t.root;
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+void rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::splice(discard_list &d, discard_list &rhs) {
+  if (rhs.head == nullptr)
+	return;
+  if (d.head == nullptr)
+	d.head = rhs.head;
+  else
+	d.tail->parent = rhs.head;
+  d.tail = rhs.tail;
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::size_type
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::destroy_discarded(discard_list &d) {
+  size_type n = 0;
+  while (d.head != nullptr) {
+	base_ptr next = d.head->parent;
+	n += erase_aux(static_cast<link_type>(d.head));
+	d.head = next;
+  }
+  d.tail = nullptr;
+  return n;
+}
+
+/* 将整棵树摘下为一棵子树，*this 随之变为空树 */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+rb_tree_subtree rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::take_subtree() {
+  rb_tree_subtree t{root(), 0};
+  if (t.root != nullptr) {
+	t.root->parent = nullptr;
+	t.black_height = rb_tree_black_height(t.root);
+  }
+  root() = 0;
+  leftmost() = header;
+  rightmost() = header;
+  node_count = 0;
+  return t;
+}
+
+/* 以子树 t 作为整棵树，n 为其节点个数 */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+void rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::put_subtree(rb_tree_subtree t, size_type n) {
+  root() = static_cast<link_type>(t.root);
+  if (t.root != nullptr) {
+	t.root->parent = header;
+	leftmost() = minimum(root());
+	rightmost() = maximum(root());
+  } else {
+	leftmost() = header;
+	rightmost() = header;
+  }
+  node_count = n;
+}
+
+/* 将 t 分为键值小于 k、等于 k、大于 k 的三棵子树 */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+void rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::split_aux(rb_tree_subtree t, const Key &k,
+																	rb_tree_subtree &less,
+																	rb_tree_subtree &equal,
+																	rb_tree_subtree &greater) const {
+  if (t.root == nullptr) {
+	less = equal = greater = rb_tree_subtree{nullptr, 0};
+	return;
+  }
+  base_ptr x = t.root;
+  rb_tree_subtree l = rb_tree_child(t, x->left);
+  rb_tree_subtree r = rb_tree_child(t, x->right);
+  if (key_compare(k, key(x))) {
+	split_aux(l, k, less, equal, greater);
+	greater = rb_tree_join(greater, x, r, node_update());
+  } else if (key_compare(key(x), k)) {
+	split_aux(r, k, less, equal, greater);
+	less = rb_tree_join(l, x, less, node_update());
+  } else {
+	// 键值允许重复时，左右子树中都可能还有与 k 相等的元素
+	rb_tree_subtree equal_left, equal_right, empty;
+	split_aux(l, k, less, equal_left, empty);
+	split_aux(r, k, empty, equal_right, greater);
+	equal = rb_tree_join(equal_left, x, equal_right, node_update());
+  }
+}
+
+/* 以 t1 的根节点 x 分割 t2，两侧分别递归求并集后再以 x 连接 */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+template<typename Fork>
+rb_tree_subtree rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::union_aux(rb_tree_subtree t1,
+																				rb_tree_subtree t2,
+																				bool unique,
+																				Fork fork,
+																				discard_list &d) const {
+  if (t1.root == nullptr) return t2;
+  if (t2.root == nullptr) return t1;
+  base_ptr x = t1.root;
+  rb_tree_subtree l1 = rb_tree_child(t1, x->left);
+  rb_tree_subtree r1 = rb_tree_child(t1, x->right);
+  rb_tree_subtree l2, e2, g2;
+  split_aux(t2, key(x), l2, e2, g2);
+  if (unique)
+	discard(d, e2);
+  else
+	l2 = rb_tree_join2(l2, e2, node_update());
+  rb_tree_subtree l, r;
+  discard_list left_discard;
+  fork([&] { l = union_aux(l1, l2, unique, fork.child(), left_discard); },
+	   [&] { r = union_aux(r1, g2, unique, fork.child(), d); });
+  splice(d, left_discard);
+  return rb_tree_join(l, x, r, node_update());
+}
+
+/* 以 t2 的根节点 x 分割 t1，t1 中与 x 键值相等的元素保留，两侧分别递归求交集 */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+template<typename Fork>
+rb_tree_subtree rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::intersection_aux(rb_tree_subtree t1,
+																					   rb_tree_subtree t2,
+																					   Fork fork,
+																					   discard_list &d) const {
+  if (t1.root == nullptr || t2.root == nullptr) {
+	discard(d, t1);
+	discard(d, t2);
+	return rb_tree_subtree{nullptr, 0};
+  }
+  base_ptr x = t2.root;
+  rb_tree_subtree l2 = rb_tree_child(t2, x->left);
+  rb_tree_subtree r2 = rb_tree_child(t2, x->right);
+  x->left = x->right = nullptr;
+  rb_tree_subtree l1, e1, g1;
+  split_aux(t1, key(x), l1, e1, g1);
+  discard(d, rb_tree_subtree{x, 1});
+  rb_tree_subtree l, r;
+  discard_list left_discard;
+  fork([&] { l = intersection_aux(l1, l2, fork.child(), left_discard); },
+	   [&] { r = intersection_aux(g1, r2, fork.child(), d); });
+  splice(d, left_discard);
+  return rb_tree_join2(rb_tree_join2(l, e1, node_update()), r, node_update());
+}
+
+/* 以 t2 的根节点 x 分割 t1，t1 中与 x 键值相等的元素舍弃，两侧分别递归求差集 */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+template<typename Fork>
+rb_tree_subtree rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::difference_aux(rb_tree_subtree t1,
+																					 rb_tree_subtree t2,
+																					 Fork fork,
+																					 discard_list &d) const {
+  if (t1.root == nullptr || t2.root == nullptr) {
+	discard(d, t2);
+	return t1;
+  }
+  base_ptr x = t2.root;
+  rb_tree_subtree l2 = rb_tree_child(t2, x->left);
+  rb_tree_subtree r2 = rb_tree_child(t2, x->right);
+  x->left = x->right = nullptr;
+  rb_tree_subtree l1, e1, g1;
+  split_aux(t1, key(x), l1, e1, g1);
+  discard(d, rb_tree_subtree{x, 1});
+  discard(d, e1);
+  rb_tree_subtree l, r;
+  discard_list left_discard;
+  fork([&] { l = difference_aux(l1, l2, fork.child(), left_discard); },
+	   [&] { r = difference_aux(g1, r2, fork.child(), d); });
+  splice(d, left_discard);
+  return rb_tree_join2(l, r, node_update());
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+template<typename Fork>
+void rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::set_operation(rb_tree &other, set_operation_type op, Fork fork) {
+  if (&other == this) {
+	if (op == op_difference) clear();
+	return;
+  }
+  size_type n = node_count + other.node_count;
+  discard_list d;
+  rb_tree_subtree t1 = take_subtree();
+  rb_tree_subtree t2 = other.take_subtree();
+  rb_tree_subtree result;
+  switch (op) {
+	case op_union_unique: result = union_aux(t1, t2, true, fork, d);
+	  break;
+	case op_union_equal: result = union_aux(t1, t2, false, fork, d);
+	  break;
+	case op_intersection: result = intersection_aux(t1, t2, fork, d);
+	  break;
+	case op_difference: result = difference_aux(t1, t2, fork, d);
+	  break;
+  }
+  n -= destroy_discarded(d);
+  put_subtree(result, n);
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+void rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::split(const Key &k, rb_tree &right) {
+  if (&right == this)
+	return;
+  right.clear();
+  size_type n = node_count;
+  rb_tree_subtree less, equal, greater;
+  split_aux(take_subtree(), k, less, equal, greater);
+  put_subtree(less, 0);
+  right.put_subtree(rb_tree_join2(equal, greater, node_update()), 0);
+  // 两侧同时向前遍历，先走完的一侧即为较小的一侧，计数只需 O(min(|*this|, |right|))
+  size_type m = 0;
+  iterator a = begin();
+  iterator b = right.begin();
+  for (; a != end() && b != right.end(); ++a, ++b) ++m;
+  node_count = a == end() ? m : n - m;
+  right.node_count = n - node_count;
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+void rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::join(rb_tree &right) {
+  if (&right == this)
+	return;
+  size_type n = node_count + right.node_count;
+  rb_tree_subtree l = take_subtree();
+  put_subtree(rb_tree_join2(l, right.take_subtree(), node_update()), n);
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::find(const Key &k) {
   link_type y = header;
   link_type x = root();
 
@@ -772,9 +1699,9 @@ rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::find(const Key &k) {
   return (j == end() || key_compare(k, key(j.node))) ? end() : j;
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::const_iterator
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::find(const Key &k) const {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::const_iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::find(const Key &k) const {
   link_type y = header;
   link_type x = root();
 
@@ -788,18 +1715,18 @@ rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::find(const Key &k) const {
   return (j == end() || key_compare(k, key(j.node))) ? end() : j;
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::size_type
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::count(const Key &k) const {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::size_type
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::count(const Key &k) const {
   std::pair<const_iterator, const_iterator> p = equal_range(k);
   size_type n = 0;
-  distance(p.first, p.second, n);
+  tinystl::distance(p.first, p.second, n);
   return n;
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::iterator
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::lower_bound(const Key &k) {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::lower_bound(const Key &k) {
   link_type y = header;
   link_type x = root();
 
@@ -811,9 +1738,9 @@ rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::lower_bound(const Key &k) {
   return iterator(y);
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::const_iterator
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::lower_bound(const Key &k) const {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::const_iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::lower_bound(const Key &k) const {
   link_type y = header;
   link_type x = root();
 
@@ -825,9 +1752,9 @@ rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::lower_bound(const Key &k) c
   return const_iterator(y);
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::iterator
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::upper_bound(const Key &k) {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::upper_bound(const Key &k) {
   link_type y = header;
   link_type x = root();
 
@@ -839,9 +1766,9 @@ rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::upper_bound(const Key &k) {
   return iterator(y);
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::const_iterator
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::upper_bound(const Key &k) const {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::const_iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::upper_bound(const Key &k) const {
   link_type y = header;
   link_type x = root();
 
@@ -853,23 +1780,112 @@ rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::upper_bound(const Key &k) c
   return const_iterator(y);
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-inline std::pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::iterator,
-				 typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::iterator>
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::equal_range(const Key &k) {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+inline std::pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::iterator,
+				 typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::iterator>
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::equal_range(const Key &k) {
   return std::pair<iterator, iterator>(lower_bound(k), upper_bound(k));
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-inline std::pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::const_iterator,
-				 typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::const_iterator>
-rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::equal_range(const Key &k) const {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+inline std::pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::const_iterator,
+				 typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::const_iterator>
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::equal_range(const Key &k) const {
   return std::pair<const_iterator, const_iterator>(lower_bound(k),
 												   upper_bound(k));
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-inline int rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::black_count(base_ptr node, base_ptr root) {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::link_type
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::select_aux(size_type n) const {
+  if (n >= node_count)
+	return header;
+  base_ptr x = header->parent;
+  for (;;) {
+	size_type left_size = subtree_size(x->left);
+	if (n < left_size) {
+	  x = x->left;
+	} else if (n == left_size) {
+	  return (link_type)x;
+	} else {
+	  n -= left_size + 1;
+	  x = x->right;
+	}
+  }
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::size_type
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::rank(const Key &k) const {
+  size_type r = 0;
+  link_type x = root();
+
+  while (x != 0)
+	if (!key_compare(key(x), k)) {
+	  x = left(x);
+	} else {
+	  r += subtree_size(x->left) + 1;
+	  x = right(x);
+	}
+  return r;
+}
+
+/* 先找到键值落在 [lo, hi) 内、深度最小的节点 x，lo 与 hi 的查找路径在此分开：
+ * 沿 x 的左子树查找 lo，途经的键值不小于 lo 的节点连同其右子树均在区间内；右侧对称 */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+template<typename A>
+typename A::data_type
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::aggregate(const Key &lo, const Key &hi) const {
+  static_assert(std::is_same<A, Augment>::value, "aggregate uses the tree's own augment");
+  link_type x = root();
+  while (x != 0) {
+	if (key_compare(key(x), lo))
+	  x = right(x);
+	else if (!key_compare(key(x), hi))
+	  x = left(x);
+	else
+	  break;
+  }
+  if (x == 0)
+	return A::identity();
+
+  typename A::data_type lhs = A::identity();
+  for (link_type y = left(x); y != 0;) {
+	if (key_compare(key(y), lo)) {
+	  y = right(y);
+	} else {
+	  lhs = A::combine(A::combine(A::make(value(y)), A::template summary<rb_tree_node>(y->right)), lhs);
+	  y = left(y);
+	}
+  }
+  typename A::data_type rhs = A::identity();
+  for (link_type y = right(x); y != 0;) {
+	if (key_compare(key(y), hi)) {
+	  rhs = A::combine(rhs, A::combine(A::template summary<rb_tree_node>(y->left), A::make(value(y))));
+	  y = right(y);
+	} else {
+	  y = left(y);
+	}
+  }
+  return A::combine(A::combine(lhs, A::make(value(x))), rhs);
+}
+
+/* 自 position 向上走到根，每次从右孩子回到父节点时，父节点及其左子树都排在 position 之前 */
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::size_type
+rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::index_of(const_iterator position) const {
+  base_ptr x = position.node;
+  if (x == header)
+	return node_count;
+  size_type r = subtree_size(x->left);
+  for (; x != header->parent; x = x->parent)
+	if (x == x->parent->right)
+	  r += subtree_size(x->parent->left) + 1;
+  return r;
+}
+
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+inline int rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::black_count(base_ptr node, base_ptr root) {
   if (node == nullptr)
 	return 0;
   else {
@@ -881,8 +1897,8 @@ inline int rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::black_count(base
   }
 }
 
-template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator>
-bool rb_tree<Key, Value, KeyOfValue, Compare, Allocator>::rb_verify() const {
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Allocator, typename Augment>
+bool rb_tree<Key, Value, KeyOfValue, Compare, Allocator, Augment>::rb_verify() const {
   if (node_count == 0 || begin() == end())
 	return node_count == 0 && begin() == end() && header->left == header &&
 		header->right == header;
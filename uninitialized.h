@@ -90,7 +90,6 @@ inline void uninitialized_fill_aux(ForwardIterator first,
   try {
 	for (; cur != last; ++cur)
 	  construct(&*cur, x);
-	return cur;
   } catch (...) {
 	destroy(first, cur);
 	throw;
@@ -396,7 +396,7 @@ inline bool operator==(const vector<T, Allocator> &lhs, const vector<T, Allocato
 
 template<typename T, typename Allocator>
 inline bool operator<(const vector<T, Allocator> &lhs, const vector<T, Allocator> &rhs) {
-  typename vector<T, Allocator>::iterator first1 = lhs.begin();
+  typename vector<T, Allocator>::const_iterator first1 = lhs.begin();
   auto last1 = lhs.end();
   auto first2 = rhs.begin();
   auto last2 = rhs.end();
@@ -0,0 +1,176 @@
+//
+// Created by polarnight on 26-10-19, 下午2:10.
+//
+
+#ifndef TINYSTL__WORK_STEALING_DEQUE_H_
+#define TINYSTL__WORK_STEALING_DEQUE_H_
+
+/* <work_stealing_deque.h> 实现了 Chase-Lev 工作窃取双端队列
+ * 队列只属于一个线程（owner），owner 在底端（bottom）push/pop，表现为一个栈，
+ * 其余线程（thief）只能从顶端（top）窃取，只有在队列中只剩一个元素时 owner 才需要与 thief 竞争。
+ * 内存次序采用 Lê, Pop, Cohen, Zappa Nardelli 为 C11 内存模型给出的版本
+ *
+ * 元素保存在可增长的环形数组中，数组写满时由 owner 配置一个两倍大小的新数组。
+ * thief 可能仍在读取旧数组，因此旧数组不会立即归还，而是串在新数组之后，直到队列析构时一并释放，
+ * 全部旧数组的大小之和小于当前数组，额外的空间开销至多一倍。
+ * 元素以 std::atomic<T> 保存，T 须为可平凡复制的类型，通常为指向任务的指针 */
+
+#include <atomic>
+#include <type_traits>
+
+#include "memory.h"
+#include "concurrent_queue.h" // for round_up_pow2
+
+namespace tinystl {
+/* 数组在多个 owner 线程中分别配置，因此缺省使用线程安全的一级配置器 */
+template<typename T, typename Allocator = malloc_alloc>
+class work_stealing_deque {
+  static_assert(std::is_trivially_copyable<T>::value, "work_stealing_deque requires a trivially copyable type");
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+
+ private:
+  /* 环形数组，下标 i 映射到 slots[i & mask] */
+  struct ring {
+	size_type mask;
+	std::atomic<T> *slots;
+	ring *retired; // 被本数组取代的旧数组
+
+	size_type capacity() const { return mask + 1; }
+	T load(difference_type i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+	void store(difference_type i, const T &value) { slots[i & mask].store(value, std::memory_order_relaxed); }
+  };
+  using ring_allocator = alloc<ring, Allocator>;
+  using slot_allocator = alloc<std::atomic<T>, Allocator>;
+
+  alignas(cache_line_size) std::atomic<difference_type> top;
+  alignas(cache_line_size) std::atomic<difference_type> bottom;
+  std::atomic<ring *> array;
+
+  static ring *get_ring(size_type capacity);
+  static void put_ring(ring *r);
+  ring *grow(ring *old_ring, difference_type b, difference_type t);
+
+ public:
+  /* capacity 会被上调至 2 的幂，至少为 2 */
+  explicit work_stealing_deque(size_type capacity = 64) {
+	top.store(0, std::memory_order_relaxed);
+	bottom.store(0, std::memory_order_relaxed);
+	array.store(get_ring(round_up_pow2(capacity < 2 ? 2 : capacity)), std::memory_order_relaxed);
+  }
+  work_stealing_deque(const work_stealing_deque &) = delete;
+  work_stealing_deque &operator=(const work_stealing_deque &) = delete;
+  ~work_stealing_deque() {
+	ring *r = array.load(std::memory_order_relaxed);
+	while (r) {
+	  ring *next = r->retired;
+	  put_ring(r);
+	  r = next;
+	}
+  }
+
+  /* capacity 相关操作，size 只是一个近似值 */
+  size_type capacity() const noexcept { return array.load(std::memory_order_relaxed)->capacity(); }
+  size_type size_approx() const noexcept {
+	difference_type b = bottom.load(std::memory_order_relaxed);
+	difference_type t = top.load(std::memory_order_relaxed);
+	return b > t ? static_cast<size_type>(b - t) : 0;
+  }
+  bool empty_approx() const noexcept { return size_approx() == 0; }
+
+  /* container 相关操作
+   * push/try_pop 只能由 owner 线程调用，try_steal 可由任意线程调用
+   * try_steal 在队列为空或与其他线程竞争失败时返回 false */
+  void push(const value_type &value);
+  bool try_pop(value_type &result);
+  bool try_steal(value_type &result);
+};
+
+template<typename T, typename Allocator>
+typename work_stealing_deque<T, Allocator>::ring *work_stealing_deque<T, Allocator>::get_ring(size_type capacity) {
+  ring *r = ring_allocator::allocate();
+  try {
+	r->slots = slot_allocator::allocate(capacity);
+  } catch (...) {
+	ring_allocator::deallocate(r);
+	throw;
+  }
+  for (size_type i = 0; i < capacity; ++i)
+	::new(static_cast<void *>(r->slots + i)) std::atomic<T>();
+  r->mask = capacity - 1;
+  r->retired = nullptr;
+  return r;
+}
+
+template<typename T, typename Allocator>
+void work_stealing_deque<T, Allocator>::put_ring(ring *r) {
+  slot_allocator::deallocate(r->slots, r->capacity());
+  ring_allocator::deallocate(r);
+}
+
+/* 将 [t, b) 中的元素搬入两倍大小的新数组，下标保持不变 */
+template<typename T, typename Allocator>
+typename work_stealing_deque<T, Allocator>::ring *
+work_stealing_deque<T, Allocator>::grow(ring *old_ring, difference_type b, difference_type t) {
+  ring *new_ring = get_ring(old_ring->capacity() * 2);
+  for (difference_type i = t; i != b; ++i)
+	new_ring->store(i, old_ring->load(i));
+  new_ring->retired = old_ring;
+  return new_ring;
+}
+
+template<typename T, typename Allocator>
+void work_stealing_deque<T, Allocator>::push(const value_type &value) {
+  difference_type b = bottom.load(std::memory_order_relaxed);
+  difference_type t = top.load(std::memory_order_acquire);
+  ring *r = array.load(std::memory_order_relaxed);
+  if (b - t > static_cast<difference_type>(r->capacity()) - 1) {
+	r = grow(r, b, t);
+	array.store(r, std::memory_order_release);
+  }
+  r->store(b, value);
+  // 以 release 写入 bottom（而非 release fence 加 relaxed 写入），与 try_steal 中 acquire 读取 bottom 配对
+  bottom.store(b + 1, std::memory_order_release);
+}
+
+template<typename T, typename Allocator>
+bool work_stealing_deque<T, Allocator>::try_pop(value_type &result) {
+  difference_type b = bottom.load(std::memory_order_relaxed) - 1;
+  ring *r = array.load(std::memory_order_relaxed);
+  bottom.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  difference_type t = top.load(std::memory_order_relaxed);
+  if (t > b) { // 队列为空
+	bottom.store(b + 1, std::memory_order_relaxed);
+	return false;
+  }
+  result = r->load(b);
+  if (t == b) { // 只剩最后一个元素，与 thief 竞争
+	bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	bottom.store(b + 1, std::memory_order_relaxed);
+	return won;
+  }
+  return true;
+}
+
+template<typename T, typename Allocator>
+bool work_stealing_deque<T, Allocator>::try_steal(value_type &result) {
+  difference_type t = top.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  difference_type b = bottom.load(std::memory_order_acquire);
+  if (t >= b)
+	return false; // 队列为空
+  ring *r = array.load(std::memory_order_acquire);
+  T value = r->load(t);
+  if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	return false;
+  result = value;
+  return true;
+}
+
+} // namespace tinystl
+
+#endif //TINYSTL__WORK_STEALING_DEQUE_H_